@@ -1,19 +1,34 @@
 #ifndef MINQND_LIBC_H
 #define MINQND_LIBC_H
 
-//**** stdint.h ****
+//**** stdint.h & stddef.h ****
 
 #include <stdint.h>
+#include <stddef.h>	// for NULL and size_t
 
 
 //**** limits.h & float.h ****
 
 #define INT_MAX 0x7fffffff
+#define INT_MIN (-INT_MAX-1)
+#define LONG_MAX __LONG_MAX__
+#define LONG_MIN (-LONG_MAX-1L)
+#define ULONG_MAX (LONG_MAX*2UL+1)
+#define LLONG_MAX __LONG_LONG_MAX__
+#define LLONG_MIN (-LLONG_MAX-1LL)
+#define ULLONG_MAX (LLONG_MAX*2ULL+1)
 #define FLT_MAX 3.4028235e38f
 #define DBL_MAX 1.7976931348623147e+308
 #define PATH_MAX 4096
 
 
+//**** errno.h ****
+
+extern int errno;
+#define EINVAL 22
+#define ERANGE 34
+
+
 //**** inttypes.h ****
 
 #if UINTPTR_MAX == UINT64_MAX
@@ -56,15 +71,20 @@ extern double fmod(double x, double y);
 extern double exp(double x);
 extern float expf(float x);
 extern double exp2(double x);
+extern double expm1(double x);
 extern double log(double x);
 extern double log2(double x);
 extern double log10(double x);
+extern double log1p(double x);
 extern double pow(double x, double y);
+extern double powi(double x, int n);
 extern double cbrt(double x);
 extern double sin(double x);
 extern double cos(double x);
 extern double sin_tr(double x);
 extern double cos_tr(double x);
+extern void sincos(double x, double *s, double *c);
+extern void sincos_tr(double x, double *s, double *c);
 extern double tan(double x);
 extern double atan(double x);
 extern double atan2(double y, double x);
@@ -75,6 +95,7 @@ extern double acos(double x);
 extern double sinh(double x);
 extern double cosh(double x);
 extern double tanh(double x);
+extern void tanh_n(double *y, const double *x, size_t n);
 extern double hypot(double x, double y);
 extern double tgamma(double x);
 extern double erf(double x);
@@ -83,6 +104,12 @@ extern double fmax(double x, double y);
 extern float fminf(float x, float y);
 extern float fmaxf(float x, float y);
 
+// Bulk conversions between float and 16-bit IEEE half floats or bfloat16, rounded to nearest even
+extern void f32_to_f16_n(uint16_t *y, const float *x, size_t n);
+extern void f16_to_f32_n(float *y, const uint16_t *x, size_t n);
+extern void f32_to_bf16_n(uint16_t *y, const float *x, size_t n);
+extern void bf16_to_f32_n(float *y, const uint16_t *x, size_t n);
+
 static float fabsf(float x) { return __builtin_fabsf(x); }
 static double fabs(double x) { return __builtin_fabs(x); }
 static float sqrtf(float x) { return __builtin_sqrtf(x); }
@@ -127,22 +154,159 @@ static float fmaf(float x, float y, float z)
 #endif
 }
 
+// Polynomial evaluation, c[0] is the coefficient of the highest degree like at the start of a Horner chain
+// Horner is one long chain of dependent FMAs, second-order Horner runs two chains (odd and even degrees)
+// in parallel and Estrin's scheme builds a tree of depth log2(n), which suits out-of-order and SIMD cores
+static inline double poly_horner(double x, const double *c, int n)
+{
+	double y = c[0];
+	for (int i=1; i < n; i++)
+		y = fma(y, x, c[i]);
+	return y;
+}
+
+static inline double poly_horner2(double x, const double *c, int n)
+{
+	double x2 = x*x, ye = 0., yo = 0.;
+
+	// The lowest 8 terms are done with a normal Horner chain, this keeps the accuracy of plain Horner
+	// where the odd and even sums would otherwise partly cancel each other (with x close to 1 in log2())
+	int nh = n > 8 ? n - 8 : 0;
+	for (int i=0; i < nh; i++)
+		if ((nh-1-i) & 1)
+			yo = fma(yo, x2, c[i]);
+		else
+			ye = fma(ye, x2, c[i]);
+
+	double y = fma(yo, x, ye);
+	for (int i=nh; i < n; i++)
+		y = fma(y, x, c[i]);
+	return y;
+}
+
+static inline double poly_estrin(double x, const double *c, int n)
+{
+	double t[32];
+	for (int i=0; i < n; i++)
+		t[i] = c[n-1-i];		// t[i] is the coefficient of x^i
+
+	// Each level pairs up terms as t[2i] + t[2i+1]*x^(2^level)
+	for (; n > 1; n = (n+1) / 2, x *= x)
+	{
+		for (int i=0; i < n/2; i++)
+			t[i] = fma(t[2*i+1], x, t[2*i]);
+		if (n & 1)
+			t[n/2] = t[n-1];
+	}
+	return t[0];
+}
+
+// The long polynomials below go through poly_eval(), define MINQND_POLY_HORNER or MINQND_POLY_ESTRIN to change the scheme
+static inline double poly_eval(double x, const double *c, int n)
+{
+#if defined(MINQND_POLY_HORNER)
+	return poly_horner(x, c, n);
+#elif defined(MINQND_POLY_ESTRIN)
+	return poly_estrin(x, c, n);
+#else
+	return poly_horner2(x, c, n);
+#endif
+}
+
+
+// 2^r - 1 for r = [-0.5 , 0.5], relative error < 2.8e-16
+static inline double exp2m1_kernel(double r)
+{
+	static const double c[] = { 4.4549605981865186e-10, 7.072585949269223e-09, 1.0178062445845774e-07, 1.321544258792169e-06, 1.525273382983612e-05, 0.0001540353044173605, 0.0013333558146416936, 0.009618129107606888, 0.0555041086648216, 0.24022650695910097, 0.6931471805599453 };
+	return poly_eval(r, c, sizeof(c)/sizeof(*c)) * r;
+}
+
+// log2(1+x) for x = [0 , 1[, error < 5.6e-16
+static inline double log2_1p_kernel(double x)
+{
+	static const double c[] = { -5.3900689426556794e-05, 0.0005968645768689283, -0.00313391341753411, 0.010442449383054555, -0.02501343559857696, 0.046471705734629686, -0.07097318971909646, 0.09384129171028438, -0.11276998895945271, 0.12855072671176712, -0.14355046191549647, 0.16014509927064696, -0.18031168969314218, 0.2060962554026628, -0.240448913785409, 0.28853899328802884, -0.3606737596975198, 0.4808983469531558, -0.7213475204444082, 1.4426950408889634 };
+	return poly_eval(x, c, sizeof(c)/sizeof(*c)) * x;
+}
+
+// Unchecked versions for inputs already known to be in range, they have no branches and are inline so that loops over them vectorise
+// The exponent bits are moved with integer shifts and magic numbers because SIMD has no conversions between int64 and double
+static inline double exp2_unchecked(double x)	// x = [-1022 , 1023.5[, relative error < 3e-16
+{
+	// k = round(x) ends up in the low mantissa bits, shifting them into the exponent gives 2^k, like in tanh_n()
+	double kd = x + 0x1.8p52;
+	double yk = int_as_double((double_as_int(kd) + 1023) << 52);
+	kd -= 0x1.8p52;
+
+	return fma(yk, exp2m1_kernel(x - kd), yk);
+}
+
+static inline double log2_unchecked(double x)	// x positive, finite and normal, absolute error < 5.6e-16, relative error grows just below 1
+{
+	// The biased exponent becomes the low mantissa bits of 2^52 + exponent, then the bias and 2^52 are subtracted
+	double dexp = int_as_double(double_as_int(x) >> 52 | 0x4330000000000000) - (0x1p52 + 1023.);
+	x = int_as_double(0x3FF0000000000000 | (double_as_int(x) & 0x000FFFFFFFFFFFFF)) - 1.;	// x -> [0 , 1[
+	return dexp + log2_1p_kernel(x);
+}
+
+static inline double cos_tr_unchecked(double x)	// x = [0 , 1] (a phase that's already wrapped), error < 3.4e-16
+{
+	x = fabs(x - 0.5) - 0.25;	// x --> [-0.25 , 0.25]
+	double x2 = x * x;
+	return ((((((((0.1007146753*x2 - 0.7176853699)*x2 + 3.81992279752)*x2 - 15.0946413686846)*x2 + 42.05869391526577)*x2 - 76.705859752634335)*x2 + 81.60524927607172)*x2 - 41.341702240399748)*x2 + 6.2831853071795865)*x;
+}
+
+static inline double atan2_unchecked(double y, double x)	// first quadrant only, x >= 0 and y >= 0 but not both 0, absolute error < 4.5e-16 radians, the relative error is large for small angles
+{
+	double z = (y-x) / (y+x);
+	static const double c[] = { 1.0855325905493e-05, -0.000127895606647823, 0.000716185939732283, -0.002548984741415465, 0.006522051887574913, -0.012912646727945627, 0.020892606648891447, -0.028973618243504723, 0.036024498001997648, -0.041870772536141579, 0.047092469780129998, -0.05249366638684719, 0.058795099763367187, -0.066662143709156916, 0.076922535641828372, -0.09090904383293701, 0.11111110827526765, -0.14285714274686638, 0.19999999999752311, -0.333333333333307, 0.99999999999999992 };
+	return poly_eval(z*z, c, sizeof(c)/sizeof(*c))*z + 0.78539816339744831;
+}
+
+static inline double asin_unchecked(double x)	// x = [0 , 0.84], absolute and relative error < 7.7e-16
+{
+	// One longer polynomial centred on xm = 0.3, no Newton-Raphson steps
+	double xm = x / (1. + sqrt(1. - x));	// 1 - sqrt(1-x) without its cancellation near 0
+	static const double c[] = { -37.640050719579364, 28.641038867800937, -3.2240546290968437, 2.5531704541803393, -6.015213024552419, 4.658203271915098, -3.1435660237975744, 2.4695824123426617, -1.9887820327149979, 1.5829682038917727, -1.269029571318691, 1.0291058979300653, -0.8445855003889038, 0.70325349905939, -0.5959390232839278, 0.5170206069624608, -0.46084747067825055, 0.4312888133679876, -0.4181048402022147, 0.4799611667131258, -0.5212412779211577, 1.7839493009186662 };
+	return poly_eval(xm - 0.3, c, sizeof(c)/sizeof(*c)) * xm;
+}
+
 
 //**** ctype.h ****
 
-extern int isspace(int c);
-extern int isdigit(int c);
-extern int isxdigit(int c);
-extern int isalpha(int c);
-extern int isalnum(int c);
-extern int isupper(int c);
-extern int tolower(int c);
-extern int isprint(int c);
+// Class bits of each byte value, only ASCII characters have any
+#define CT_CNTRL	1
+#define CT_SPACE	2
+#define CT_PRINT	4
+#define CT_PUNCT	8
+#define CT_DIGIT	16
+#define CT_XDIGIT	32	// only a-f and A-F
+#define CT_UPPER	64
+#define CT_LOWER	128
+extern const uint8_t ctype_table[256];
+
+static inline int iscntrl(int c)  { return ctype_table[(uint8_t) c] & CT_CNTRL; }
+static inline int isspace(int c)  { return ctype_table[(uint8_t) c] & CT_SPACE; }
+static inline int isblank(int c)  { return c == ' ' || c == '\t'; }
+static inline int isprint(int c)  { return ctype_table[(uint8_t) c] & CT_PRINT; }
+static inline int isgraph(int c)  { return (ctype_table[(uint8_t) c] & (CT_PRINT|CT_SPACE)) == CT_PRINT; }
+static inline int ispunct(int c)  { return ctype_table[(uint8_t) c] & CT_PUNCT; }
+static inline int isdigit(int c)  { return ctype_table[(uint8_t) c] & CT_DIGIT; }
+static inline int isxdigit(int c) { return ctype_table[(uint8_t) c] & (CT_DIGIT|CT_XDIGIT); }
+static inline int isupper(int c)  { return ctype_table[(uint8_t) c] & CT_UPPER; }
+static inline int islower(int c)  { return ctype_table[(uint8_t) c] & CT_LOWER; }
+static inline int isalpha(int c)  { return ctype_table[(uint8_t) c] & (CT_UPPER|CT_LOWER); }
+static inline int isalnum(int c)  { return ctype_table[(uint8_t) c] & (CT_UPPER|CT_LOWER|CT_DIGIT); }
+static inline int tolower(int c)  { return isupper(c) ? c | 32 : c; }
+static inline int toupper(int c)  { return islower(c) ? c & ~32 : c; }
+
+// Bulk versions, dst can be src, count_class_n() counts the bytes that have any of the CT_* bits of classes
+extern void str_tolower_n(char *dst, const char *src, size_t n);
+extern void str_toupper_n(char *dst, const char *src, size_t n);
+extern size_t count_class_n(const char *s, size_t n, int classes);
 
 
 //**** stdio.h ****
 
-#include <stddef.h>	// for NULL and size_t
 #define EOF (-1)
 #define SEEK_SET 0
 #define SEEK_CUR 1
@@ -154,19 +318,41 @@ extern int isprint(int c);
 #define va_arg(v,l)     __builtin_va_arg(v,l)
 #define va_copy(d,s)    __builtin_va_copy(d,s)
 
-typedef int FILE;	// we don't actually use FILE for now
+// Memory streams and read-only files are their buffer, written files buffer what goes to fd
+typedef struct minqnd_file
+{
+	char *buf;
+	size_t size, len, pos;		// capacity, end of the data, position
+	int flags, fd;			// fd is -1 for memory streams
+	int64_t offset;			// file offset of buf[0] for written files
+	char **mem_ptr;			// open_memstream() outputs, kept up to date after each write
+	size_t *mem_size;
+} FILE;
+
 extern FILE *const stdin;
 extern FILE *const stdout;
 extern FILE *const stderr;
-static char *fgets(char *s, int n, FILE *stream) { return NULL; }
-static int fprintf(FILE *stream, const char *format, ...) { return -1; }
-static FILE *fopen(const char *filename, const char *mode) { return NULL; }
-static int fclose(FILE *stream) { return EOF; }
-static size_t fread(void *ptr, size_t size, size_t nmemb, FILE *stream) { return EOF; }
-static size_t fwrite(const void *ptr, size_t size, size_t nmemb, FILE *stream) { return EOF; }
-static int fseek(FILE *stream, long int offset, int whence) { return EOF; }
-static long int ftell(FILE *stream) { return 0; }
-static void rewind(FILE *stream) { }
+extern FILE *fmemopen(void *buf, size_t size, const char *mode);	// a NULL buf is allocated and freed by fclose()
+extern FILE *open_memstream(char **ptr, size_t *sizeloc);		// *ptr is null-terminated and must be freed by the caller
+extern FILE *fopen(const char *filename, const char *mode);
+extern int fclose(FILE *stream);
+extern int fflush(FILE *stream);
+extern int vfprintf(FILE *stream, const char *format, va_list arg);
+extern int fprintf(FILE *stream, const char *format, ...);
+extern int fputs(const char *s, FILE *stream);
+extern int fputc(int c, FILE *stream);
+extern char *fgets(char *s, int n, FILE *stream);
+extern int fgetc(FILE *stream);
+extern size_t fread(void *ptr, size_t size, size_t nmemb, FILE *stream);
+extern size_t fwrite(const void *ptr, size_t size, size_t nmemb, FILE *stream);
+extern int fseek(FILE *stream, long int offset, int whence);
+extern long int ftell(FILE *stream);
+extern void rewind(FILE *stream);
+extern int feof(FILE *stream);
+extern int ferror(FILE *stream);
+extern void clearerr(FILE *stream);
+#define putc fputc
+#define getc fgetc
 
 extern void *memset(void *dest, int c, size_t n);
 extern void *memcpy(void *dest, const void *src, size_t n);
@@ -183,6 +369,86 @@ extern int strncmp(const char *s1, const char *s2, size_t n);
 extern int memcmp(const void *s1, const void *s2, size_t n);
 extern char *strcpy(char *s1, const char *s2);
 extern char *strncpy(char *s1, const char *s2, size_t n);
+extern size_t strnlen(const char *s, size_t maxlen);
+extern char *stpcpy(char *s1, const char *s2);
+extern size_t strlcpy(char *dst, const char *src, size_t size);
+extern size_t strlcat(char *dst, const char *src, size_t size);
+
+// Small constant sizes and string literals don't need a call, they become a few loads and stores
+// Define MINQND_NO_INLINE_MEM if something else declares these functions after this header
+#ifndef MINQND_NO_INLINE_MEM
+#define MINQND_INLINE_MEM_MAX 32
+#define MINQND_INLINE_N(n) (__builtin_constant_p(n) && (size_t) (n) <= MINQND_INLINE_MEM_MAX)
+
+static inline void *memmove_small(void *dest, const void *src, size_t n)
+{
+	uint8_t t[MINQND_INLINE_MEM_MAX];	// everything is loaded before anything is stored so overlaps are fine
+	__builtin_memcpy(t, src, n);
+	return __builtin_memcpy(dest, t, n);
+}
+
+// Loads n <= 8 bytes as a number that compares like the bytes do (first byte most significant), in as few loads as the size allows
+static inline uint64_t load_be_small(const uint8_t *p, size_t n)
+{
+	uint64_t v = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	size_t o = 0;
+	if (n == 8) __builtin_memcpy(&v, p, 8);
+	if (n & 4) { uint32_t w; __builtin_memcpy(&w, p, 4); v = w; o = 4; }
+	if (n & 2) { uint16_t w; __builtin_memcpy(&w, &p[o], 2); v |= (uint64_t) w << o*8; o += 2; }
+	if (n & 1) v |= (uint64_t) p[o] << o*8;
+	return __builtin_bswap64(v);
+#else
+	for (size_t i=0; i < n; i++)
+		v = v << 8 | p[i];
+	return v;
+#endif
+}
+
+static inline int memcmp_small(const void *s1, const void *s2, size_t n)
+{
+	const uint8_t *a = s1, *b = s2;
+	for (size_t i=0; i < n; i += 8)
+	{
+		uint64_t x = load_be_small(&a[i], n-i < 8 ? n-i : 8), y = load_be_small(&b[i], n-i < 8 ? n-i : 8);
+		if (x != y)
+			return x > y ? 1 : -1;
+	}
+	return 0;
+}
+
+#define memset(dest, c, n)	(MINQND_INLINE_N(n) ? __builtin_memset(dest, c, n) : (memset)(dest, c, n))
+#define memcpy(dest, src, n)	(MINQND_INLINE_N(n) ? __builtin_memcpy(dest, src, n) : (memcpy)(dest, src, n))
+#define memmove(dest, src, n)	(MINQND_INLINE_N(n) ? memmove_small(dest, src, n) : (memmove)(dest, src, n))
+#define memcmp(s1, s2, n)	(MINQND_INLINE_N(n) ? memcmp_small(s1, s2, n) : (memcmp)(s1, s2, n))
+#define strlen(s)		(__builtin_constant_p(s) ? __builtin_strlen(s) : (strlen)(s))
+#endif
+
+// String views are a pointer and a length, they aren't null-terminated and never need strlen() again
+struct str_view { const char *s; size_t len; };
+#define SV_LIT(lit) ((struct str_view) { lit, sizeof(lit)-1 })
+static inline struct str_view sv_from_cstr(const char *s) { return (struct str_view) { s, strlen(s) }; }
+static inline struct str_view sv_sub(struct str_view v, size_t start, size_t len) { start = start < v.len ? start : v.len; return (struct str_view) { v.s + start, len < v.len - start ? len : v.len - start }; }
+static inline int sv_eq(struct str_view a, struct str_view b) { return a.len == b.len && memcmp(a.s, b.s, a.len) == 0; }
+static inline int sv_starts_with(struct str_view v, struct str_view prefix) { return v.len >= prefix.len && memcmp(v.s, prefix.s, prefix.len) == 0; }
+extern int sv_cmp(struct str_view a, struct str_view b);
+extern size_t sv_find_char(struct str_view v, char c);			// the offset of the first c, v.len if there's none
+extern size_t sv_find(struct str_view v, struct str_view needle);	// the offset of the first needle, v.len if there's none
+extern struct str_view sv_split(struct str_view *rest, char sep);	// the part before sep, *rest becomes what follows sep
+extern size_t sv_copy(char *dst, size_t size, struct str_view v);	// null-terminated like strlcpy(), returns v.len
+
+// Iterates over the records of a buffer that end with delim, the views point into the buffer and exclude the delimiter
+struct line_iter { const char *p, *end; char delim; };
+static inline struct line_iter line_iter_init(const void *buf, size_t len, char delim) { return (struct line_iter) { buf, (const char *) buf + len, delim }; }
+extern int line_iter_next(struct line_iter *it, struct str_view *line);	// 0 when there are none left, the last one needs no delimiter
+extern struct line_iter line_iter_file(FILE *stream, char delim);	// takes the rest of a read stream, valid until fclose()
+extern void hex_encode(char *dst, const void *src, size_t n);
+extern size_t hex_decode(void *dst, const char *src, size_t n);
+extern size_t hexdump(char *s, size_t n, const void *data, size_t len, size_t offset);
+extern size_t utf8_validate(const char *s, size_t n);			// the length of the valid prefix, n if it's all valid
+extern size_t utf8_count_codepoints(const char *s, size_t n);		// counts the bytes that aren't continuation bytes
+extern size_t utf8_decode_n(uint32_t *dst, const char *src, size_t n);	// returns the codepoint count, invalid bytes become U+FFFD
+extern size_t utf8_encode_n(char *dst, const uint32_t *src, size_t n);	// returns the byte count (4n at most), invalid codepoints become U+FFFD
 
 extern int vsnprintf(char *s, size_t n, const char *format, va_list arg);
 extern int vsprintf(char *s, const char *format, va_list arg);
@@ -190,6 +456,25 @@ extern int snprintf(char *s, size_t n, const char *format, ...);
 extern int sprintf(char *s, const char *format, ...);
 extern int vsscanf(const char *s, const char *format, va_list arg);
 extern int sscanf(const char *s, const char *format, ...);
+extern int vsnscanf(const char *s, size_t n, const char *format, va_list arg);	// reads no more than n bytes of s
+extern int sv_scanf(struct str_view v, const char *format, ...);
+
+// Deferred logging, log_deferred() only stores the format pointer and the raw argument words in a ring buffer
+// and the text is made later by log_ring_decode(), off the critical path or by the host reading the buffer.
+// The format and the strings given for %s must still be valid when decoded, string literals are ideal.
+// One thread can log while another one decodes.
+#define LOG_RING_MAX_ARGS 16
+struct log_ring
+{
+	uint64_t *buf;
+	size_t size;		// in words, must be a power of 2
+	size_t head, tail;	// words written and read so far
+	size_t dropped;		// records that didn't fit
+};
+extern void log_ring_init(struct log_ring *r, uint64_t *buf, size_t size);
+extern int log_deferred(struct log_ring *r, const char *format, ...);
+extern int log_ring_decode(struct log_ring *r, char *s, size_t n);
+extern int vsnprintf_words(char *s, size_t n, const char *format, const uint64_t *args, size_t arg_count);	// conversions past arg_count get 0
 
 
 //**** stdlib.h ****
@@ -198,17 +483,40 @@ extern int abs(int j);
 extern long long int llabs(long long int j);
 extern int atoi(const char *nptr);
 extern double atof(const char *nptr);
+extern void *malloc(size_t size);		// the allocator is separate (CIT Alloc)
+extern void *realloc(void *ptr, size_t size);
+extern void free(void *ptr);
 extern double strtod(const char *nptr, char **endptr);
+extern long strtol(const char *nptr, char **endptr, int base);
+extern unsigned long strtoul(const char *nptr, char **endptr, int base);
+extern long long strtoll(const char *nptr, char **endptr, int base);
+extern unsigned long long strtoull(const char *nptr, char **endptr, int base);
 extern void srand(unsigned int seed);
 extern int rand(void);
 extern void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *));
+extern void qsort_parallel(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *));	// single-threaded without MINQND_THREADS
 extern void abort(void);
 
 
+//**** pthread.h ****
+
+// Build with MINQND_THREADS and link a pthreads implementation (the native one or wasi-libc's with WASM threads)
+#ifdef MINQND_THREADS
+typedef unsigned long pthread_t;
+extern int pthread_create(pthread_t *thread, const void *attr, void *(*start_routine)(void *), void *arg);
+extern int pthread_join(pthread_t thread, void **retval);
+#endif
+
+
 //**** time.h ****
 
 typedef int64_t time_t;
+typedef int clockid_t;
 struct tm { int tm_sec, tm_min, tm_hour, tm_mday, tm_mon, tm_year, tm_wday, tm_yday, tm_isdst; };
+struct timespec { time_t tv_sec; long tv_nsec; };
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+extern int clock_gettime(clockid_t clock_id, struct timespec *tp);	// from the OS natively, from the host import on WASM
 extern time_t time(time_t *timer);
 extern double difftime(time_t time1, time_t time0);
 extern struct tm *gmtime(const time_t *timer);
@@ -219,31 +527,198 @@ extern time_t timegm(struct tm *tm);
 extern time_t mktime(struct tm *timeptr);
 extern size_t strftime(char * restrict s, size_t maxsize, const char *format, const struct tm *timeptr);
 
+// Pre-compiled strftime format, parsed once by strftime_compile() (which returns the rest of the format if it didn't all fit) and reused by strftime_compiled()
+struct strftime_op { const char *lit; uint16_t lit_len; char conv; };
+struct strftime_fmt { struct strftime_op op[32]; int count; };
+extern const char *strftime_compile(struct strftime_fmt *f, const char *format);
+extern size_t strftime_compiled(char *s, size_t maxsize, const struct strftime_fmt *f, const struct tm *timeptr);
+
 
-//**** Other ****
+//**** unistd.h & fcntl.h ****
 
+// From the OS natively, from the host imports on WASM which take the same Linux flag values
+#define O_RDONLY 0
+#define O_WRONLY 1
+#define O_RDWR 2
+#define O_CREAT 0100
+#define O_TRUNC 01000
+#define O_APPEND 02000
+extern int open(const char *path, int flags, ...);
+#ifdef __wasm__
 #if INTPTR_MAX == INT64_MAX
 typedef long long ssize_t;
 #else
 typedef long ssize_t;
 #endif
+typedef int64_t off_t;
+extern int close(int fd);
+extern ssize_t read(int fd, void *buf, size_t n);
+extern ssize_t write(int fd, const void *buf, size_t n);
+extern off_t lseek(int fd, off_t offset, int whence);
+#else
+#include <unistd.h>	// the OS's own off_t and ssize_t, and lseek() as its large file variant when off_t is 64-bit
+#endif
+
+
+//**** Profiling ****
+
+// Build with MINQND_PROFILE to count the calls and bytes of each function in minqnd_prof_table[],
+// add MINQND_PROFILE_TIME to also add up the nanoseconds spent in them (nested calls are included)
+#define MINQND_PROF_LIST(X) \
+	X(fmod) X(exp) X(expf) X(exp2) X(expm1) X(log) X(log2) X(log10) X(log1p) X(pow) X(powi) X(cbrt) \
+	X(sinf) X(cosf) X(sin) X(cos) X(sin_tr) X(cos_tr) X(sincos) X(sincos_tr) X(tan) X(atan) X(atan2) X(atan2f) X(asin) X(asinf) X(acos) \
+	X(sinh) X(cosh) X(tanh) X(tanh_n) X(hypot) X(erf) X(fmin) X(fmax) X(fminf) X(fmaxf) \
+	X(f32_to_f16_n) X(f16_to_f32_n) X(f32_to_bf16_n) X(bf16_to_f32_n) \
+	X(str_tolower_n) X(str_toupper_n) X(count_class_n) \
+	X(atoi) X(atof) X(strtod) X(strtol) X(strtoul) X(strtoll) X(strtoull) X(rand) X(qsort) X(qsort_parallel) \
+	X(memset) X(memcpy) X(memmove) X(strlen) X(memchr) X(memrchr) X(strchr) X(strrchr) X(strpbrk) X(strstr) \
+	X(strcmp) X(strncmp) X(memcmp) X(strcpy) X(strncpy) X(strnlen) X(stpcpy) X(strlcpy) X(strlcat) \
+	X(sv_cmp) X(sv_find_char) X(sv_find) X(sv_split) X(sv_copy) X(line_iter_next) X(hex_encode) X(hex_decode) X(hexdump) \
+	X(utf8_validate) X(utf8_count_codepoints) X(utf8_decode_n) X(utf8_encode_n) \
+	X(vsnprintf) X(vsnprintf_words) X(vsscanf) X(vsnscanf) X(log_deferred) X(log_ring_decode) \
+	X(fopen) X(fmemopen) X(open_memstream) X(fflush) X(vfprintf) X(fwrite) X(fread) X(fgets) \
+	X(time) X(gmtime_r) X(timegm) X(strftime) X(strftime_compiled)
+
+#ifdef MINQND_PROFILE
+#define X(name) minqnd_prof_id_##name,
+enum { MINQND_PROF_LIST(X) minqnd_prof_count };
+#undef X
+
+struct minqnd_prof_entry { uint64_t calls, bytes, ns; };
+extern struct minqnd_prof_entry minqnd_prof_table[minqnd_prof_count];
+extern const char *const minqnd_prof_name[minqnd_prof_count];
+extern int minqnd_prof_dump(char *s, size_t n);
+extern void minqnd_prof_reset(void);
+
+#ifdef MINQND_PROFILE_TIME
+struct minqnd_prof_scope { struct minqnd_prof_entry *e; int64_t t0; };
+
+static inline int64_t minqnd_prof_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline struct minqnd_prof_scope minqnd_prof_begin(struct minqnd_prof_entry *e, uint64_t bytes)
+{
+	e->calls++;
+	e->bytes += bytes;
+	return (struct minqnd_prof_scope) { e, minqnd_prof_now() };
+}
+
+static inline void minqnd_prof_end(struct minqnd_prof_scope *sc) { sc->e->ns += minqnd_prof_now() - sc->t0; }
+
+  // The time is added when the scope variable goes out of scope, whichever way the function returns
+  #define MINQND_PROF(name, b) struct minqnd_prof_scope minqnd_prof_sc __attribute__((cleanup(minqnd_prof_end))) = minqnd_prof_begin(&minqnd_prof_table[minqnd_prof_id_##name], b)
+#else
+  #define MINQND_PROF(name, b) (minqnd_prof_table[minqnd_prof_id_##name].calls++, minqnd_prof_table[minqnd_prof_id_##name].bytes += (b))
+#endif
+  #define MINQND_PROF_BYTES(name, b) (minqnd_prof_table[minqnd_prof_id_##name].bytes += (b))
+#else
+  #define MINQND_PROF(name, b)
+  #define MINQND_PROF_BYTES(name, b)
+#endif
 
 #endif // MINQND_LIBC_H
 
 
 #ifdef MINQND_LIBC_IMPLEMENTATION
 
+//**** errno.h ****
+
+int errno;
+
+
+//**** CPU dispatch ****
+
+// Native x86-64 builds get AVX-512 (x86-64-v4), AVX2 (v3) and baseline SSE2 clones of the loop kernels, picked once by an ifunc resolver when the program loads
+// WASM has a single SIMD width and NEON is always there on AArch64 so there's nothing to pick, define MINQND_NO_DISPATCH to build a single version
+#if defined(__x86_64__) && defined(__ELF__) && !defined(__wasm__) && !defined(MINQND_NO_DISPATCH) && (__GNUC__ >= 12 || __clang_major__ >= 14)
+  #define MINQND_DISPATCH __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+  #define MINQND_DISPATCH
+#endif
+
+
 //**** math.h ****
 
-double fmod(double x, double y) { return x - trunc(x / y) * y; }
+// Define MINQND_MATH_TABLES to use the table-assisted exp2() and log2() with short polynomials (2.5 kB of tables)
+#ifdef MINQND_MATH_TABLES
+// 2^(i/64)
+static const double exp2_table[64] = {
+	1.0, 1.0108892860517005, 1.0218971486541166, 1.0330248790212284, 1.0442737824274138, 1.0556451783605572, 1.0671404006768237, 1.0787607977571199,
+	1.0905077326652577, 1.102382583307841, 1.1143867425958924, 1.1265216186082418, 1.1387886347566916, 1.1511892299529827, 1.1637248587775775, 1.1763969916502812,
+	1.189207115002721, 1.202156731452703, 1.215247359980469, 1.22848053610687, 1.241857812073484, 1.255380757024691, 1.2690509571917332, 1.2828700160787783,
+	1.2968395546510096, 1.3109612115247644, 1.3252366431597413, 1.339667524053303, 1.3542555469368927, 1.3690024229745905, 1.383909881963832, 1.3989796725383112,
+	1.4142135623730951, 1.42961333839197, 1.4451808069770467, 1.460917794180647, 1.4768261459394993, 1.4929077282912648, 1.5091644275934228, 1.5255981507445384,
+	1.5422108254079407, 1.559004400237837, 1.5759808451078865, 1.593142151342267, 1.6104903319492543, 1.6280274218573478, 1.645755478153965, 1.6636765803267364,
+	1.681792830507429, 1.7001063537185235, 1.718619298122478, 1.7373338352737062, 1.7562521603732995, 1.7753764925265212, 1.7947090750031072, 1.8142521755003989,
+	1.8340080864093424, 1.8539791250833855, 1.8741676341103, 1.8945759815869656, 1.9152065613971474, 1.9360617934922943, 1.9571441241754002, 1.978456026387951,
+};
+
+// { 1/c , -log2(1/c) } with c = 1 + i/128, -log2(1/c) is for the rounded 1/c
+static const double log2_table[129][2] = {
+	{ 1.0, 0.0 }, { 0.9922480620155039, 0.01122725542325414 }, { 0.9846153846153847, 0.022367813028454427 }, { 0.9770992366412213, 0.033423001537450335 },
+	{ 0.9696969696969697, 0.044394119358453395 }, { 0.9624060150375939, 0.05528243550118968 }, { 0.9552238805970149, 0.06608919045777246 }, { 0.9481481481481482, 0.07681559705083084 },
+	{ 0.9411764705882353, 0.08746284125033943 }, { 0.9343065693430657, 0.09803208296052676 }, { 0.927536231884058, 0.10852445677816903 }, { 0.920863309352518, 0.11894107272350736 },
+	{ 0.9142857142857143, 0.1292830169449665 }, { 0.9078014184397163, 0.1395513523987936 }, { 0.9014084507042254, 0.14974711950468203 }, { 0.8951048951048951, 0.1598713367783894 },
+	{ 0.8888888888888888, 0.16992500144231246 }, { 0.8827586206896552, 0.1799090900149345 }, { 0.8767123287671232, 0.1898245588800173 }, { 0.8707482993197279, 0.19967234483636445 },
+	{ 0.8648648648648649, 0.2094533656289497 }, { 0.8590604026845637, 0.2191685204621616 }, { 0.8533333333333334, 0.22881869049588077 }, { 0.847682119205298, 0.2384047393250789 },
+	{ 0.8421052631578947, 0.24792751344358557 }, { 0.8366013071895425, 0.25738784269265175 }, { 0.8311688311688312, 0.26678654069490126 }, { 0.8258064516129032, 0.27612440527423754 },
+	{ 0.8205128205128205, 0.28540221886224837 }, { 0.8152866242038217, 0.2946207488916269 }, { 0.810126582278481, 0.30378074817710293 }, { 0.8050314465408805, 0.3128829552843553 },
+	{ 0.8, 0.3219280948873623 }, { 0.7950310559006211, 0.33091687811461706 }, { 0.7901234567901234, 0.3398500028846248 }, { 0.7852760736196319, 0.3487281542310775 },
+	{ 0.7804878048780488, 0.3575520046180836 }, { 0.7757575757575758, 0.3663222142458158 }, { 0.7710843373493976, 0.3750394313469247 }, { 0.7664670658682635, 0.38370429247405213 },
+	{ 0.7619047619047619, 0.39231742277876036 }, { 0.757396449704142, 0.40087943628218436 }, { 0.7529411764705882, 0.4093909361377018 }, { 0.7485380116959064, 0.4178525148858979 },
+	{ 0.7441860465116279, 0.42626475470209796 }, { 0.7398843930635838, 0.4346282276367247 }, { 0.735632183908046, 0.44294349584872833 }, { 0.7314285714285714, 0.4512111118323288 },
+	{ 0.7272727272727273, 0.4594316186372972 }, { 0.7231638418079096, 0.4676055500829974 }, { 0.7191011235955056, 0.4757334309663978 }, { 0.7150837988826816, 0.4838157772642564 },
+	{ 0.7111111111111111, 0.49185309632967467 }, { 0.7071823204419889, 0.49984588708320543 }, { 0.7032967032967034, 0.5077946401986961 }, { 0.6994535519125683, 0.5156998382840424 },
+	{ 0.6956521739130435, 0.523561956057013 }, { 0.6918918918918919, 0.5313814605163121 }, { 0.6881720430107527, 0.5391588111080313 }, { 0.6844919786096256, 0.5468944598876367 },
+	{ 0.6808510638297872, 0.5545888516776374 }, { 0.6772486772486772, 0.5622424242210727 }, { 0.6736842105263158, 0.5698556083309478 }, { 0.6701570680628273, 0.5774288280357486 },
+	{ 0.6666666666666666, 0.5849625007211563 }, { 0.6632124352331606, 0.5924570372680804 }, { 0.6597938144329897, 0.5999128421871277 }, { 0.6564102564102564, 0.6073303137496107 },
+	{ 0.6530612244897959, 0.6147098441152083 }, { 0.649746192893401, 0.6220518194563763 }, { 0.6464646464646465, 0.6293566200796095 }, { 0.6432160804020101, 0.6366246205436488 },
+	{ 0.64, 0.6438561897747247 }, { 0.6368159203980099, 0.6510516911789287 }, { 0.6336633663366337, 0.6582114827517948 }, { 0.6305418719211823, 0.6653359171851763 },
+	{ 0.6274509803921569, 0.6724253419714956 }, { 0.624390243902439, 0.6794800995054461 }, { 0.6213592233009708, 0.6865005271832185 }, { 0.6183574879227053, 0.6934869574993253 },
+	{ 0.6153846153846154, 0.7004397181410921 }, { 0.6124401913875598, 0.7073591320808829 }, { 0.6095238095238096, 0.7142455176661225 }, { 0.6066350710900474, 0.721099188707185 },
+	{ 0.6037735849056604, 0.7279204545631992 }, { 0.6009389671361502, 0.7347096202258382 }, { 0.5981308411214953, 0.741466986401147 }, { 0.5953488372093023, 0.7481928495894603 },
+	{ 0.5925925925925926, 0.7548875021634687 }, { 0.5898617511520737, 0.7615512324444793 }, { 0.5871559633027523, 0.7681843247769263 }, { 0.5844748858447488, 0.7747870596011734 },
+	{ 0.5818181818181818, 0.7813597135246597 }, { 0.579185520361991, 0.7879025593914314 }, { 0.5765765765765766, 0.794415866350106 }, { 0.5739910313901345, 0.8008998999203047 },
+	{ 0.5714285714285714, 0.8073549220576042 }, { 0.5688888888888889, 0.8137811912170371 }, { 0.5663716814159292, 0.8201789624151877 }, { 0.5638766519823789, 0.8265484872909149 },
+	{ 0.5614035087719298, 0.8328900141647417 }, { 0.5589519650655022, 0.839203788096944 }, { 0.5565217391304348, 0.8454900509443752 }, { 0.5541125541125541, 0.8517490414160576 },
+	{ 0.5517241379310345, 0.8579809951275721 }, { 0.5493562231759657, 0.8641861446542802 }, { 0.5470085470085471, 0.8703647195834043 }, { 0.5446808510638298, 0.8765169465649997 },
+	{ 0.5423728813559322, 0.8826430493618412 }, { 0.540084388185654, 0.8887432488982592 }, { 0.5378151260504201, 0.8948177633079436 }, { 0.5355648535564853, 0.9008668079807487 },
+	{ 0.5333333333333333, 0.9068905956085186 }, { 0.5311203319502075, 0.9128893362299616 }, { 0.5289256198347108, 0.9188632372745945 }, { 0.5267489711934157, 0.9248125036057808 },
+	{ 0.5245901639344263, 0.9307373375628862 }, { 0.5224489795918368, 0.9366379390025704 }, { 0.5203252032520326, 0.9425145053392397 }, { 0.5182186234817814, 0.9483672315846776 },
+	{ 0.5161290322580645, 0.9541963103868752 }, { 0.5140562248995983, 0.960001932068081 }, { 0.512, 0.965784284662087 }, { 0.5099601593625498, 0.971543553950772 },
+	{ 0.5079365079365079, 0.9772799234999165 }, { 0.5059288537549407, 0.9829935746943103 }, { 0.5039370078740157, 0.9886846867721659 }, { 0.5019607843137255, 0.9943534368588579 },
+	{ 0.5, 1.0 },
+};
+#endif
+
+double fmod(double x, double y) { MINQND_PROF(fmod, 0); return x - trunc(x / y) * y; }
 
-double exp(double x) { return exp2(x*1.4426950408889634); }
-float expf(float x) { return exp(x); }
+double exp(double x) { MINQND_PROF(exp, 0); return exp2(x*1.4426950408889634); }
+float expf(float x) { MINQND_PROF(expf, 0); return exp(x); }
 double exp2(double x)
 {
+	MINQND_PROF(exp2, 0);
 	if (x < -1022.)	return 0.;
 	if (x > 1024.)	return INFINITY;
 
+#ifdef MINQND_MATH_TABLES
+	// x = k/64 + r, 2^(k/64) comes from the table and its exponent, r = [-1/128 , 1/128]
+	double k = floor(x*64. + 0.5);
+	double r = x - k * (1./64.);
+	int64_t ki = k;
+	if (ki >= 1024*64)	// the result is still finite for x = ]1024-1/128 , 1024]
+		return 2. * exp2(x - 1.);
+	double yk = int_as_double(double_as_int(exp2_table[ki & 63]) + ((uint64_t) (ki >> 6) << 52));
+
+	// yr = 2^r - 1, error < 1e-16, the 1 is added last to avoid one rounding
+	double yr = ((((0.0013333558146428443*r + 0.009618129107628477)*r + 0.05550410866482158)*r + 0.24022650695910072)*r + 0.6931471805599453)*r;
+
+	return fma(yk, yr, yk);
+#else
 	// Calculate the integer exponent part so that ye = 2^xe
 	double xe = floor(x);
 	double ye = int_as_double(((int64_t) xe + 1023) << 52);
@@ -253,81 +728,275 @@ double exp2(double x)
 	double yf = ((((((((((6.302690884e-10*xf + 6.537941907e-09)*xf + 1.025834708428e-07)*xf + 1.32076762706e-06)*xf + 1.5253232908459e-05)*xf + 0.000154035091891941)*xf + 0.0013333558738165096)*xf + 0.0096181290971755593)*xf + 0.055504108665909871)*xf + 0.24022650695904222)*xf + 0.69314718055994654)*xf + 1.;
 
 	return ye * yf;
+#endif
 }
 
-double log(double x) { return log2(x) * 0.6931471805599453; }
-double log2(double x)	// error < 5.6e-16 in x = [1 , 2]
+double expm1(double x)
 {
+	MINQND_PROF(expm1, 0);
+	double y = x * 1.4426950408889634;
+	if (y < -60.)	return -1.;
+	if (y > 1023.)	return exp2(y);
+
+	// x = k*ln(2) + r with ln(2) in two parts so that large x don't lose precision like exp() does
+	double k = floor(y + 0.5);
+	double r = fma(k, -6.93147180369123816490e-01, x);
+	r = fma(k, -1.90821492927058770002e-10, r) * 1.4426950408889634;
+
+	// 2^y - 1 = 2^k * (2^r - 1) + (2^k - 1) which is exact for k = 0
+	double yk = int_as_double(((int64_t) k + 1023) << 52);
+	return fma(yk, exp2m1_kernel(r), yk - 1.);
+}
+
+double log(double x) { MINQND_PROF(log, 0); return log2(x) * 0.6931471805599453; }
+double log2(double x)	// absolute error < 4.3e-16, relative error < 4.2e-16 (2.2e-15 with MINQND_MATH_TABLES)
+{
+	MINQND_PROF(log2, 0);
 	if (x == 0.) return -INFINITY;
 	if (isfinite(x) == 0 || x < 0.)	return NAN;
+
+	// Near 1 the result keeps its relative accuracy from log2(1+x) of x-1, and below 1 of (1-x)/x so that the exponent doesn't cancel out
+	if (x > 0.75 && x < 1.0625)
+		return x < 1. ? -log2_1p_kernel((1. - x) / x) : log2_1p_kernel(x - 1.);
+#ifdef MINQND_MATH_TABLES
 	int dexp = ((double_as_int(x) >> 52) & 0x7FF) - 1023;
-	x = int_as_double(0x3FF0000000000000 | (double_as_int(x) & 0x000FFFFFFFFFFFFF)) - 1.;	// x -> [0 , 1[
-	double mlog = (((((((((((((((((((-3.875403760417e-05*x + 0.00044698118761163)*x - 0.00244848531481462)*x + 0.00852083615839964)*x - 0.0213191869638036)*x + 0.04131053521866153)*x - 0.065555177283666503)*x + 0.089482861465356655)*x - 0.11005436646074359)*x + 0.12723476135812695)*x - 0.14305519031975983)*x + 0.16000129093273448)*x - 0.18027986442557736)*x + 0.20609098709475556)*x - 0.24044827892686577)*x + 0.28853893972854774)*x - 0.36067375670991322)*x + 0.48089834685222948)*x - 0.72134752044262604)*x + 1.442695040888951)*x;
-	return (double) dexp + mlog;
+
+	// x = c * (1+r) with c = 1 + j/128 the nearest table point and r = [-1/256 , 1/256]
+	int j = ((double_as_int(x) & 0x000FFFFFFFFFFFFF) + (1ULL << 44)) >> 45;
+	x = int_as_double(0x3FF0000000000000 | (double_as_int(x) & 0x000FFFFFFFFFFFFF));	// x -> [1 , 2[
+	double r = fma(x, log2_table[j][0], -1.);
+	double mlog = ((((0.2885430009202478*r - 0.36067841841976644)*r + 0.48089834694751776)*r - 0.7213475204264334)*r + 1.4426950408889634)*r;	// error < 6e-17
+	return ((double) dexp + log2_table[j][1]) + mlog;
+#else
+	return log2_unchecked(x);
+#endif
+}
+double log10(double x) { MINQND_PROF(log10, 0); return log2(x) * 0.3010299956639812; }
+double log1p(double x)
+{
+	MINQND_PROF(log1p, 0);
+	// 1+x is never rounded for x = ]-0.5 , 1[, below 0 we use log(1+x) = -log(1 + -x/(1+x))
+	if (x >= 0. && x < 1.)
+		return log2_1p_kernel(x) * 0.6931471805599453;
+	if (x > -0.5 && x < 0.)
+		return log2_1p_kernel(-x / (1. + x)) * -0.6931471805599453;
+	return log(1. + x);
+}
+double pow(double x, double y)	// relative error < 5e-15 for |y| <= 4, it grows with |log2(x) * y| up to 2.5e-14 for |y| <= 30
+{
+	MINQND_PROF(pow, 0);
+
+	// Common exponents
+	if (y == 2.)			return x*x;
+	if (y == 0.5 && x > 0.)	return sqrt(x);
+	if (y == -0.5 && x > 0.)	return 1. / sqrt(x);
+	if (y == 1./3. && x > 0.)	return cbrt(x);
+
+	// Small integer exponents are done by squaring, which is exact for small results
+	if (y == trunc(y) && fabs(y) <= 64.)
+		return powi(x, y);
+
+	// Special values from Annex F, the log2 path would give NaN for them
+	if (x == 1.)
+		return 1.;
+	if (isnan(x) || isnan(y))
+		return x + y;
+	if (x == 0. || !isfinite(x))	// odd integer exponents keep the sign of x
+	{
+		double r = (x == 0.) == (y < 0.) ? INFINITY : 0.;
+		return signbit(x) && fabs(fmod(y, 2.)) == 1. ? -r : r;
+	}
+
+	// Infinite exponents only depend on |x|
+	if (!isfinite(y))
+	{
+		if (fabs(x) == 1.)
+			return 1.;
+		return (fabs(x) < 1.) == (y < 0.) ? INFINITY : 0.;
+	}
+
+	// Negative base with large integer exponents, odd exponents give a negative result
+	if (x < 0. && y == trunc(y))
+	{
+		double r = exp2(log2(-x) * y);
+		return fmod(y, 2.) == 0. ? r : -r;
+	}
+
+	return exp2(log2(x) * y);
 }
-double log10(double x) { return log2(x) * 0.3010299956639812; }
-double pow(double x, double y) { return exp2(log2(x) * y); }
-double cbrt(double x) { return pow(x, 1./3.); }
 
-float sinf(float x) { return sin(x); }
-float cosf(float x) { return cos(x); }
-double sin(double x) { return sin_tr(x * (1./(2.*M_PI))); }
-double cos(double x) { return cos_tr(x * (1./(2.*M_PI))); }
-double sin_tr(double x) { return cos_tr(x - 0.25); }
-double cos_tr(double x)	// error < 3.4e-16
+double powi(double x, int n)
 {
-	x = fabs(x - floor(x) - 0.5) - 0.25;	// x --> [-0.25 , 0.25]
-	double x2 = x * x;
-	return ((((((((0.1007146753*x2 - 0.7176853699)*x2 + 3.81992279752)*x2 - 15.0946413686846)*x2 + 42.05869391526577)*x2 - 76.705859752634335)*x2 + 81.60524927607172)*x2 - 41.341702240399748)*x2 + 6.2831853071795865)*x;
+	MINQND_PROF(powi, 0);
+	unsigned int u = n < 0 ? -(unsigned int) n : n;
+	double r = 1.;
+	for (; u; u >>= 1, x *= x)
+		if (u & 1)
+			r *= x;
+	return n < 0 ? 1. / r : r;
+}
+
+double cbrt(double x)	// error < 1 ULP
+{
+	MINQND_PROF(cbrt, 0);
+	double xa = fabs(x);
+	if (xa == 0. || isfinite(x) == 0)
+		return x;
+	if (xa < 2.2250738585072014e-308)		// subnormals are scaled up
+		return cbrt(x * 0x1p54) * 0x1p-18;
+
+	// r = 1/cbrt(xa) guessed from the exponent bits (error < 3.5%), then 3 division-free Newton steps
+	double r = int_as_double(0x553EF00000000000 - double_as_int(xa) / 3);
+	for (int i=0; i < 3; i++)
+		r += r * (1. - xa*r*r*r) * (1./3.);
+
+	// y = cbrt(xa) with one last Newton step on y itself
+	double y = xa * r * r;
+	y += (xa - y*y*y) * r*r * (1./3.);
+	return copysign(y, x);
+}
+
+float sinf(float x) { MINQND_PROF(sinf, 0); return sin(x); }
+float cosf(float x) { MINQND_PROF(cosf, 0); return cos(x); }
+double sin(double x) { MINQND_PROF(sin, 0); return sin_tr(x * (1./(2.*M_PI))); }
+double cos(double x) { MINQND_PROF(cos, 0); return cos_tr(x * (1./(2.*M_PI))); }
+double sin_tr(double x) { MINQND_PROF(sin_tr, 0); return cos_tr(x - 0.25); }
+double cos_tr(double x)	// absolute and relative error < 3.5e-16
+{
+	MINQND_PROF(cos_tr, 0);
+	return cos_tr_unchecked(x - floor(x));
 }
 
-double tan(double x) { return sin(x) / cos(x); }
-double atan(double x) { return atan2(x, 1.); }
-float atan2f(float y, float x) { return atan2(y, x); }
-double atan2(double y, double x)	// error < 4.5e-16 radians
+// Both polynomials are evaluated together as one 2-lane vector with the range reduction done once
+void sincos(double x, double *s, double *c) { MINQND_PROF(sincos, 0); sincos_tr(x * (1./(2.*M_PI)), s, c); }
+void sincos_tr(double x, double *s, double *c)
 {
-	double xa = fabs(x), ya = fabs(y);
-	double z = (ya-xa) / (ya+xa);
-	double z2 = z * z;
-	z = ((((((((((((((((((((1.0855325905493e-05*z2 - 0.000127895606647823)*z2 + 0.000716185939732283)*z2 - 0.002548984741415465)*z2 + 0.006522051887574913)*z2 - 0.012912646727945627)*z2 + 0.020892606648891447)*z2 - 0.028973618243504723)*z2 + 0.036024498001997648)*z2 - 0.041870772536141579)*z2 + 0.047092469780129998)*z2 - 0.05249366638684719)*z2 + 0.058795099763367187)*z2 - 0.066662143709156916)*z2 + 0.076922535641828372)*z2 - 0.09090904383293701)*z2 + 0.11111110827526765)*z2 - 0.14285714274686638)*z2 + 0.19999999999752311)*z2 - 0.333333333333307)*z2 + 0.99999999999999992)*z + 0.78539816339744831;
+	MINQND_PROF(sincos_tr, 0);
+	__attribute__((__vector_size__(2 * sizeof(double)))) double xv, x2;
+	double f = x - floor(x);			// f = [0 , 1[
+	double fs = f < 0.25 ? f + 0.75 : f - 0.25;	// f - 0.25 wrapped back to [0 , 1[
+	xv[0] = fabs(fs - 0.5) - 0.25;			// x --> [-0.25 , 0.25]
+	xv[1] = fabs(f - 0.5) - 0.25;
+	x2 = xv * xv;
+	xv = ((((((((0.1007146753*x2 - 0.7176853699)*x2 + 3.81992279752)*x2 - 15.0946413686846)*x2 + 42.05869391526577)*x2 - 76.705859752634335)*x2 + 81.60524927607172)*x2 - 41.341702240399748)*x2 + 6.2831853071795865)*xv;
+	*s = xv[0];
+	*c = xv[1];
+}
+
+double tan(double x) { MINQND_PROF(tan, 0); double s, c; sincos(x, &s, &c); return s / c; }
+double atan(double x) { MINQND_PROF(atan, 0); return atan2(x, 1.); }
+float atan2f(float y, float x) { MINQND_PROF(atan2f, 0); return atan2(y, x); }
+double atan2(double y, double x)	// absolute error < 5.5e-16 radians, relative error < 3.4e-15
+{
+	MINQND_PROF(atan2, 0);
+	double z, ya = fabs(y), xa = fabs(x);
+
+	// Small angles lose their relative accuracy in atan2_unchecked(), atan(t) = t - t^3/3 + t^5/5 ... keeps it
+	if (ya < 0.0625 * xa)
+	{
+		double t = ya / xa, t2 = t * t;
+		z = fma(t * t2, ((((((1./13.)*t2 - 1./11.)*t2 + 1./9.)*t2 - 1./7.)*t2 + 1./5.)*t2 - 1./3.), t);
+	}
+	else
+		z = atan2_unchecked(ya, xa);
 	if (x < 0.)	z = M_PI - z;
 	if (y < 0.)	z = -z;
 	return z;
 }
 
-float asinf(float x) { return asin(x); }
-double asin(double x)	// error < 7e-16
+float asinf(float x) { MINQND_PROF(asinf, 0); return asin(x); }
+double asin(double x)	// absolute and relative error < 7.7e-16
 {
+	MINQND_PROF(asin, 0);
 	double y, xa = fabs(x);
-	double xm = 1. - sqrt(1. - xa);
+	double xm = xa / (1. + sqrt(1. - xa));
 	if (xm > 0.6)
 		y = (((((((((((-0.00184090735900975*xm + 0.0204313986896723)*xm - 0.1052467657067292)*xm + 0.335492459818416)*xm - 0.7435462926619241)*xm + 1.2237228343719441)*xm - 1.5646256928232335)*xm + 1.6235101917880144)*xm - 1.4315658943509152)*xm + 1.1918839257926788)*xm - 0.97470740300978645)*xm + 1.9971348885324504)*xm + 0.00015358371331862;
+	else
+		y = asin_unchecked(xa);
+	return copysign(y, x);
+}
+
+double acos(double x) { MINQND_PROF(acos, 0); return 0.5*M_PI - asin(x); }
+
+// The hyperbolic functions use one exponential and its reciprocal, above 22 e^-x is negligible
+// and e^x/2 = e^(x/2) * e^(x/2)/2 so that it doesn't overflow before the result does
+double sinh(double x)
+{
+	MINQND_PROF(sinh, 0);
+	double y, xa = fabs(x);
+	if (xa > 22.)
+	{
+		double e = expm1(0.5*xa) + 1.;
+		y = (0.5*e) * e;
+	}
 	else
 	{
-		y = ((((0.2003*xm - 0.6249)*xm + 0.94057)*xm - 0.93961)*xm + 1.9963)*xm;
-		for (int i=0; i < 2; i++)	// Newton-Raphson steps
-		{
-			double s = sin(y);
-			double c = sqrt(1. - s*s);
-			y -= (s - xa) / c;
-		}
+		double em = expm1(xa);		// no cancellation near 0
+		y = 0.5 * (em + em / (em + 1.));
 	}
 	return copysign(y, x);
 }
 
-double acos(double x) { return 0.5*M_PI - asin(x); }
-double sinh(double x) { return (exp(x) - exp(-x)) * 0.5; }
-double cosh(double x) { return (exp(x) + exp(-x)) * 0.5; }
-double tanh(double x) { double e = exp(2.*x); return (e-1.) / (e+1.); }
-double hypot(double x, double y) { return sqrt(x*x + y*y); }
+double cosh(double x)
+{
+	MINQND_PROF(cosh, 0);
+	double xa = fabs(x);
+	double e = expm1(xa > 22. ? 0.5*xa : xa) + 1.;
+	if (xa > 22.)
+		return (0.5*e) * e;
+	return 0.5 * (e + 1. / e);
+}
+
+double tanh(double x)
+{
+	MINQND_PROF(tanh, 0);
+	double xa = fabs(x);
+	if (xa > 20.)
+		return copysign(1., x);
+	double em = expm1(2.*xa);
+	return copysign(em / (em + 2.), x);
+}
+
+// Branchless tanh() for arrays that the compiler can vectorise, for activation functions and the like
+MINQND_DISPATCH void tanh_n(double *y, const double *x, size_t n)
+{
+	MINQND_PROF(tanh_n, n * sizeof(double));
+	for (size_t i=0; i < n; i++)
+	{
+		double xa = fabs(x[i]);
+		double t = (xa < 20. ? xa : 20.) * 2.8853900817779268;		// 2|x| / ln(2)
+
+		// k = round(t) ends up in the low mantissa bits, shifting them into the exponent gives 2^k
+		double kd = t + 0x1.8p52;
+		double yk = int_as_double((double_as_int(kd) + 1023) << 52);
+		kd -= 0x1.8p52;
+
+		double em = fma(yk, exp2m1_kernel(t - kd), yk - 1.);
+		double r = copysign(em / (em + 2.), x[i]);
+		y[i] = x[i] != x[i] ? x[i] : r;		// NaN would otherwise be clamped to 20 and give +-1
+	}
+}
+
+double hypot(double x, double y) { MINQND_PROF(hypot, 0); return sqrt(x*x + y*y); }
 double tgamma(double x) { return NAN; }	// TODO
 
-double erf(double x)	// error < 1.5e-15
+double erf(double x)	// absolute error < 7.5e-16, relative error < 1.4e-15
 {
+	MINQND_PROF(erf, 0);
 	double y, xa = fabs(x);
 	if (xa > 6.)
 		return copysign(1., x);
-	y = (((((((((((((((((((((3.847446425233e-15*xa - 1.67842955663171e-13)*xa + 3.477665942359862e-12)*xa - 4.5278406665374846e-11)*xa + 4.1431968115923484e-10)*xa - 2.8191376405557979e-09)*xa + 1.4694293215089563e-08)*xa - 5.9193430766414834e-08)*xa + 1.817739597449057e-07)*xa - 3.9725626384852649e-07)*xa + 4.713180470756501e-07)*xa + 4.889167169868577e-07)*xa - 3.217811989057157e-06)*xa + 6.5040168714717147e-06)*xa + 1.641819587052259e-05)*xa - 2.883536587780375e-05)*xa + 0.00034381014214142996)*xa + 0.0012709605848389835)*xa + 0.0033952701135075287)*xa + 0.024538445328735638)*xa + 0.08952465548981831)*xa + 0.14104739588692786)*xa + 1.;
+
+	// Near 0 the Maclaurin series keeps the relative accuracy that 1 - y^-8 loses
+	if (xa < 0.5)
+	{
+		static const double cs[] = { -1.2290555301717928e-09, 1.4807192815879218e-08, -1.6365844691234924e-07, 1.6462114365889248e-06, -1.492565035840625e-05, 0.00012055332981789664, -0.0008548327023450853, 0.005223977625442188, -0.026866170645131252, 0.11283791670955126, -0.37612638903183754, 1.1283791670955126 };
+		return poly_eval(x*x, cs, sizeof(cs)/sizeof(*cs)) * x;
+	}
+
+	static const double c[] = { 3.847446425233e-15, -1.67842955663171e-13, 3.477665942359862e-12, -4.5278406665374846e-11, 4.1431968115923484e-10, -2.8191376405557979e-09, 1.4694293215089563e-08, -5.9193430766414834e-08, 1.817739597449057e-07, -3.9725626384852649e-07, 4.713180470756501e-07, 4.889167169868577e-07, -3.217811989057157e-06, 6.5040168714717147e-06, 1.641819587052259e-05, -2.883536587780375e-05, 0.00034381014214142996, 0.0012709605848389835, 0.0033952701135075287, 0.024538445328735638, 0.08952465548981831, 0.14104739588692786, 1. };
+	y = poly_eval(xa, c, sizeof(c)/sizeof(*c));
 	y = y*y; y = y*y; y = y*y;	// y = 1 - y^-8
 	return copysign(1. - 1./y, x);
 }
@@ -337,6 +1006,7 @@ double erf(double x)	// error < 1.5e-15
 
 double fmin(double x, double y)
 {
+	MINQND_PROF(fmin, 0);
 	if (isnan(x)) return y;
 	if (isnan(y)) return x;
 	if (signbit(x) != signbit(y)) return signbit(x) ? x : y;
@@ -345,6 +1015,7 @@ double fmin(double x, double y)
 
 double fmax(double x, double y)
 {
+	MINQND_PROF(fmax, 0);
 	if (isnan(x)) return y;
 	if (isnan(y)) return x;
 	if (signbit(x) != signbit(y)) return signbit(x) ? y : x;
@@ -353,6 +1024,7 @@ double fmax(double x, double y)
 
 float fminf(float x, float y)
 {
+	MINQND_PROF(fminf, 0);
 	if (isnan(x)) return y;
 	if (isnan(y)) return x;
 	if (signbit(x) != signbit(y)) return signbit(x) ? x : y;
@@ -361,6 +1033,7 @@ float fminf(float x, float y)
 
 float fmaxf(float x, float y)
 {
+	MINQND_PROF(fmaxf, 0);
 	if (isnan(x)) return y;
 	if (isnan(y)) return x;
 	if (signbit(x) != signbit(y)) return signbit(x) ? y : x;
@@ -370,46 +1043,162 @@ float fmaxf(float x, float y)
 #undef _MINN
 #undef _MAXN
 
+// 16-bit floats are converted 4 at a time with only integer and float ops on vectors, no branches
+typedef float f32x4 __attribute__((__vector_size__(4 * sizeof(float))));
+typedef uint32_t u32x4 __attribute__((__vector_size__(4 * sizeof(uint32_t))));
+
+// The loads and stores handle the last n%4 values by padding with zeroes
+static inline u32x4 load_f32x4(const float *x, size_t n)	{ u32x4 v = {0}; for (int i=0; i < 4 && i < n; i++) v[i] = float_as_int(x[i]); return v; }
+static inline u32x4 load_u16x4(const uint16_t *x, size_t n)	{ u32x4 v = {0}; for (int i=0; i < 4 && i < n; i++) v[i] = x[i]; return v; }
+static inline void store_f32x4(float *y, u32x4 v, size_t n)	{ for (int i=0; i < 4 && i < n; i++) y[i] = int_as_float(v[i]); }
+static inline void store_u16x4(uint16_t *y, u32x4 v, size_t n)	{ for (int i=0; i < 4 && i < n; i++) y[i] = v[i]; }
+
+static inline u32x4 f32_to_f16_x4(u32x4 f)
+{
+	u32x4 sign = f & 0x80000000;
+	f ^= sign;
+
+	// Normal, the exponent is rebiased and the mantissa rounded to nearest even, overflows carry into inf
+	u32x4 normal = (f + ((uint32_t) (15-127) << 23) + 0xFFF + ((f >> 13) & 1)) >> 13;
+
+	// Below 2^-14, adding 0.5f aligns the mantissa so that the float addition rounds it
+	u32x4 sub = (u32x4) ((f32x4) f + 0.5f) - 0x3F000000;
+
+	// Inf and NaN, a NaN stays a quiet NaN with the top of its payload
+	u32x4 inf = 0x7C00 | ((u32x4) (f > 0x7F800000) & (0x200 | (f >> 13 & 0x3FF)));
+
+	u32x4 is_sub = (u32x4) (f < 0x38800000), is_inf = (u32x4) (f >= 0x47800000);
+	return (sub & is_sub) | (inf & is_inf) | (normal & ~(is_sub | is_inf)) | sign >> 16;
+}
+
+static inline u32x4 f16_to_f32_x4(u32x4 h)
+{
+	u32x4 o = (h & 0x7FFF) << 13;
+	u32x4 exp = o & 0x0F800000;
+	o += (127-15) << 23;
+
+	// Inf and NaN get the maximum exponent, NaNs are made quiet
+	u32x4 is_inf = (u32x4) (exp == 0x0F800000);
+	o += is_inf & (128-16) << 23;
+	o |= is_inf & (u32x4) ((h & 0x3FF) != 0) & 0x00400000;
+
+	// Subnormals get the exponent of 2^-14 then the float subtraction normalises them
+	u32x4 is_sub = (u32x4) (exp == 0);
+	u32x4 sub = (u32x4) ((f32x4) (o + (1 << 23)) - 0x1p-14f);
+	return (sub & is_sub) | (o & ~is_sub) | (h & 0x8000) << 16;
+}
+
+static inline u32x4 f32_to_bf16_x4(u32x4 f)
+{
+	u32x4 is_nan = (u32x4) ((f & 0x7FFFFFFF) > 0x7F800000);
+	u32x4 rounded = (f + 0x7FFF + ((f >> 16) & 1)) >> 16;
+	return (rounded & ~is_nan) | ((f >> 16 | 0x40) & is_nan);
+}
+
+MINQND_DISPATCH void f32_to_f16_n(uint16_t *y, const float *x, size_t n)
+{
+	MINQND_PROF(f32_to_f16_n, n * sizeof(float));
+	size_t i;
+	for (i=0; i+4 <= n; i+=4)
+		store_u16x4(&y[i], f32_to_f16_x4(load_f32x4(&x[i], 4)), 4);
+	if (i < n)
+		store_u16x4(&y[i], f32_to_f16_x4(load_f32x4(&x[i], n-i)), n-i);
+}
+
+MINQND_DISPATCH void f16_to_f32_n(float *y, const uint16_t *x, size_t n)
+{
+	MINQND_PROF(f16_to_f32_n, n * sizeof(uint16_t));
+	size_t i;
+	for (i=0; i+4 <= n; i+=4)
+		store_f32x4(&y[i], f16_to_f32_x4(load_u16x4(&x[i], 4)), 4);
+	if (i < n)
+		store_f32x4(&y[i], f16_to_f32_x4(load_u16x4(&x[i], n-i)), n-i);
+}
+
+MINQND_DISPATCH void f32_to_bf16_n(uint16_t *y, const float *x, size_t n)
+{
+	MINQND_PROF(f32_to_bf16_n, n * sizeof(float));
+	size_t i;
+	for (i=0; i+4 <= n; i+=4)
+		store_u16x4(&y[i], f32_to_bf16_x4(load_f32x4(&x[i], 4)), 4);
+	if (i < n)
+		store_u16x4(&y[i], f32_to_bf16_x4(load_f32x4(&x[i], n-i)), n-i);
+}
+
+MINQND_DISPATCH void bf16_to_f32_n(float *y, const uint16_t *x, size_t n)
+{
+	MINQND_PROF(bf16_to_f32_n, n * sizeof(uint16_t));
+	for (size_t i=0; i < n; i++)
+		y[i] = int_as_float((uint32_t) x[i] << 16);
+}
+
 
 //**** ctype.h ****
 
-int isspace(int c) { return c == ' ' || (unsigned)c-'\t' < 5; }
-int isdigit(int c) { return (unsigned)c-'0' < 10; }
-int isxdigit(int c) { return isdigit(c) || ((unsigned)c|32)-'a' < 6; }
-int isalpha(int c) { return ((unsigned)c|32)-'a' < 26; }
-int isalnum(int c) { return isalpha(c) || isdigit(c); }
-int isupper(int c) { return (unsigned)c-'A' < 26; }
-int tolower(int c) { if (isupper(c)) return c | 32; return c; }
-int isprint(int c) { return (unsigned)c-0x20 < 0x5f; }
+const uint8_t ctype_table[256] = {
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x06, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C,
+	0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C,
+	0x0C, 0x64, 0x64, 0x64, 0x64, 0x64, 0x64, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44,
+	0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C,
+	0x0C, 0xA4, 0xA4, 0xA4, 0xA4, 0xA4, 0xA4, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84,
+	0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x84, 0x0C, 0x0C, 0x0C, 0x0C, 0x01,
+};
+
+// The bulk loops use comparisons instead of the table so that they get vectorised
+MINQND_DISPATCH void str_tolower_n(char *dst, const char *src, size_t n)
+{
+	MINQND_PROF(str_tolower_n, n);
+	for (size_t i=0; i < n; i++)
+		dst[i] = src[i] + (((uint8_t) (src[i] - 'A') < 26) << 5);
+}
 
+MINQND_DISPATCH void str_toupper_n(char *dst, const char *src, size_t n)
+{
+	MINQND_PROF(str_toupper_n, n);
+	for (size_t i=0; i < n; i++)
+		dst[i] = src[i] - (((uint8_t) (src[i] - 'a') < 26) << 5);
+}
 
-//**** stdio.h ****
+MINQND_DISPATCH size_t count_class_n(const char *s, size_t n, int classes)
+{
+	MINQND_PROF(count_class_n, n);
+	uint8_t cntrl = !!(classes & CT_CNTRL), space = !!(classes & CT_SPACE), print = !!(classes & CT_PRINT), punct = !!(classes & CT_PUNCT);
+	uint8_t digit = !!(classes & CT_DIGIT), xdigit = !!(classes & CT_XDIGIT), upper = !!(classes & CT_UPPER), lower = !!(classes & CT_LOWER);
+	size_t count = 0;
+
+	for (size_t i=0; i < n; i++)
+	{
+		uint8_t c = s[i];
+		uint8_t is_digit = (uint8_t) (c - '0') < 10, is_upper = (uint8_t) (c - 'A') < 26, is_lower = (uint8_t) (c - 'a') < 26;
+		uint8_t is_graph = (uint8_t) (c - '!') < 94;
+		count += (cntrl & ((c < 32) | (c == 127)))
+			| (space & ((c == ' ') | ((uint8_t) (c - '\t') < 5)))
+			| (print & (is_graph | (c == ' ')))
+			| (punct & is_graph & !(is_digit | is_upper | is_lower))
+			| (digit & is_digit)
+			| (xdigit & ((uint8_t) ((c | 32) - 'a') < 6))
+			| (upper & is_upper)
+			| (lower & is_lower);
+	}
 
-FILE *const stdin = NULL;
-FILE *const stdout = NULL;
-FILE *const stderr = NULL;
+	return count;
+}
 
 
 //**** stdlib.h ****
 
 int abs(int j) { return j > 0 ? j : -j; }
 long long int llabs(long long int j) { return j > 0 ? j : -j; }
-int atoi(const char *nptr) { int v=0; sscanf(nptr, "%d", &v); return v; }
-double atof(const char *nptr) { double v=0; sscanf(nptr, "%lg", &v); return v; }
-
-double strtod(const char *nptr, char **endptr)
-{
-	double v = NAN;
-	int n = 0;
-	sscanf(nptr, "%lg%n", &v, &n);
-	*endptr = (char *) &nptr[n];
-	return v;
-}
+int atoi(const char *nptr) { MINQND_PROF(atoi, 0); return strtol(nptr, NULL, 10); }
+double atof(const char *nptr) { MINQND_PROF(atof, 0); return strtod(nptr, NULL); }
 
 static uint64_t libc_rand_seed;
 void srand(unsigned int seed) { libc_rand_seed = seed - 1; }
 int rand(void)
 {
+	MINQND_PROF(rand, 0);
 	libc_rand_seed = 6364136223846793005ULL * libc_rand_seed + 1;
 	return libc_rand_seed >> 33;
 }
@@ -420,6 +1209,7 @@ int rand(void)
 
 void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *))
 {
+	MINQND_PROF(qsort, nmemb * size);
 	size_t wnel, gap, wgap, i, j, s;
 	char *a, *b, tmp;
 	if (size == 0) return;
@@ -446,6 +1236,80 @@ void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, co
 	}
 }
 
+#ifdef MINQND_THREADS
+#ifndef MINQND_SORT_DEPTH
+#define MINQND_SORT_DEPTH 3	// up to 2^3 threads
+#endif
+
+struct qsort_task { char *base; size_t nmemb, size; int (*compar)(const void *, const void *); int depth; };
+
+static void qsort_swap(char *a, char *b, size_t size)
+{
+	char tmp;
+	if (a != b)
+		do { tmp = *a; *a++ = *b; *b++ = tmp; } while (--size);
+}
+
+// Partitions around a median of 3 pivot then sorts both sides concurrently, the leaves are sorted by qsort()
+static void *qsort_task(void *arg)
+{
+	struct qsort_task t = *(struct qsort_task *) arg;
+	size_t i = 0, j = t.nmemb;
+	char *a = t.base;
+	#define EL(i) &a[(i) * t.size]
+
+	if (t.depth <= 0 || t.nmemb < 1 << 15)
+	{
+		qsort(a, t.nmemb, t.size, t.compar);
+		return NULL;
+	}
+
+	// Put the median of the first, middle and last elements at the start
+	char *p0 = EL(0), *p1 = EL(t.nmemb/2), *p2 = EL(t.nmemb-1);
+	if (t.compar(p1, p0) < 0) qsort_swap(p1, p0, t.size);
+	if (t.compar(p2, p1) < 0) qsort_swap(p2, p1, t.size);
+	if (t.compar(p1, p0) < 0) qsort_swap(p1, p0, t.size);
+	qsort_swap(p0, p1, t.size);
+
+	// Hoare partition, the pivot ends up at j with nothing greater on its left or smaller on its right
+	for (;;)
+	{
+		do i++; while (i < t.nmemb && t.compar(EL(i), a) < 0);
+		do j--; while (t.compar(EL(j), a) > 0);
+		if (i >= j)
+			break;
+		qsort_swap(EL(i), EL(j), t.size);
+	}
+	qsort_swap(a, EL(j), t.size);
+
+	struct qsort_task left = { a, j, t.size, t.compar, t.depth-1 };
+	struct qsort_task right = { EL(j+1), t.nmemb - j-1, t.size, t.compar, t.depth-1 };
+	#undef EL
+
+	// The left side goes to a new thread, or is done here if there can't be one
+	pthread_t thread;
+	int threaded = pthread_create(&thread, NULL, qsort_task, &left) == 0;
+	if (threaded == 0)
+		qsort_task(&left);
+	qsort_task(&right);
+	if (threaded)
+		pthread_join(thread, NULL);
+	return NULL;
+}
+#endif
+
+void qsort_parallel(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *))
+{
+	MINQND_PROF(qsort_parallel, nmemb * size);
+#ifdef MINQND_THREADS
+	struct qsort_task t = { base, nmemb, size, compar, MINQND_SORT_DEPTH };
+	if (size)
+		qsort_task(&t);
+#else
+	qsort(base, nmemb, size, compar);
+#endif
+}
+
 void abort(void) { __builtin_trap(); }
 
 
@@ -453,8 +1317,9 @@ void abort(void) { __builtin_trap(); }
 
 #define BULK_MEMORY_THRESHOLD 4  // 32 in WASI libc
 
-void *memset(void *dest, int c, size_t n)
+MINQND_DISPATCH void *(memset)(void *dest, int c, size_t n)
 {
+	MINQND_PROF(memset, n);
 #if defined(__wasm_bulk_memory__)
 	if (n > BULK_MEMORY_THRESHOLD) return __builtin_memset(dest, c, n);
 #endif
@@ -463,8 +1328,9 @@ void *memset(void *dest, int c, size_t n)
 	return dest;
 }
 
-void *memcpy(void *dest, const void *src, size_t n)
+MINQND_DISPATCH void *(memcpy)(void *dest, const void *src, size_t n)
 {
+	MINQND_PROF(memcpy, n);
 #if defined(__wasm_bulk_memory__)
 	if (n > BULK_MEMORY_THRESHOLD) return __builtin_memcpy(dest, src, n);
 #endif
@@ -474,8 +1340,9 @@ void *memcpy(void *dest, const void *src, size_t n)
 	return dest;
 }
 
-void *memmove(void *dest, const void *src, size_t n)
+MINQND_DISPATCH void *(memmove)(void *dest, const void *src, size_t n)
 {
+	MINQND_PROF(memmove, n);
 #if defined(__wasm_bulk_memory__)
 	if (n > BULK_MEMORY_THRESHOLD) return __builtin_memmove(dest, src, n);
 #endif
@@ -488,23 +1355,47 @@ void *memmove(void *dest, const void *src, size_t n)
 	return dest;
 }
 
-size_t strlen(const char *s)
+size_t (strlen)(const char *s)
 {
+	MINQND_PROF(strlen, 0);
 	const char *e;
 	for (e=s; *e; e++) {}
+	MINQND_PROF_BYTES(strlen, e-s);
 	return e-s;
 }
 
-void *memchr(const void *s, int c, size_t n)
+typedef uint64_t u64x4 __attribute__((__vector_size__(4 * sizeof(uint64_t))));
+
+MINQND_DISPATCH void *memchr(const void *s, int c, size_t n)
 {
+	MINQND_PROF(memchr, n);
 	const unsigned char *sc = s;
 	c = (unsigned char)c;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	// 32 bytes at a time, bytes equal to c become zero and the lowest high bit set by (x - 0x01..) & ~x & 0x80.. marks the first one
+	const uint64_t ones = 0x0101010101010101ULL;
+	for (; n >= 32; sc += 32, n -= 32)
+	{
+		u64x4 x;
+		__builtin_memcpy(&x, sc, 32);
+		x ^= ones * c;
+		x = (x - ones) & ~x & (ones << 7);
+		if (x[0] | x[1] | x[2] | x[3])
+		{
+			int i = x[0] ? 0 : x[1] ? 1 : x[2] ? 2 : 3;
+			return (void *) &sc[i*8 + __builtin_ctzll(x[i]) / 8];
+		}
+	}
+#endif
+
 	for (; n && *sc != c; sc++, n--);
 	return n ? (void *)sc : 0;
 }
 
 void *memrchr(const void *s, int c, size_t n)
 {
+	MINQND_PROF(memrchr, n);
 	const unsigned char *sc = s;
 	c = (unsigned char) c;
 	while (n--)
@@ -515,15 +1406,26 @@ void *memrchr(const void *s, int c, size_t n)
 
 char *strchr(const char *s, int c)
 {
+	MINQND_PROF(strchr, 0);
 	c = (unsigned char)c;
 	if (!c) return (char *)s + strlen(s);
 	for (; *s && *(unsigned char *)s != c; s++);
 	return *(unsigned char *)s == (unsigned char)c ? (char *)s : 0;
 }
 
-char *strrchr(const char *s, int c) { return memrchr(s, c, strlen(s) + 1); }
+char *strrchr(const char *s, int c)
+{
+	MINQND_PROF(strrchr, 0);
+	const char *last = NULL;
+	size_t i = 0;
+	c = (unsigned char) c;
+	do { if (((unsigned char *) s)[i] == c) last = &s[i]; } while (s[i++]);
+	MINQND_PROF_BYTES(strrchr, i);
+	return (char *) last;
+}
 
 char *strpbrk(const char *s1, const char *s2) {
+	MINQND_PROF(strpbrk, 0);
 	size_t i1, i2;
 	for (i1 = 0; s1[i1]; i1++) for (i2 = 0; s2[i2]; i2++) if (s1[i1] == s2[i2]) return (char *) &s1[i1];
 	return (char *) &s1[i1];
@@ -531,60 +1433,468 @@ char *strpbrk(const char *s1, const char *s2) {
 
 char *strstr(const char *s1, const char *s2) 
 {
-	char c, sc;
-	if ((c = *s2++) != 0)
+	MINQND_PROF(strstr, 0);
+	size_t i;
+	for (;; s1++)
 	{
-		size_t len = strlen(s2);
-		do { do { if ((sc = *s1++) == 0) return NULL; } while (sc != c); } while (strncmp(s1, s2, len) != 0);
-		s1--;
+		for (i=0; s2[i] && s1[i] == s2[i]; i++) {}
+		if (s2[i] == '\0')
+			return (char *) s1;
+		if (s1[i] == '\0')	// what's left of s1 is shorter than s2
+			return NULL;
 	}
-	return (char *) s1;
 }
 
 int strcmp(const char *s1, const char *s2)
 {
+	MINQND_PROF(strcmp, 0);
 	for (; *s1==*s2 && *s1; s1++, s2++);
 	return *(unsigned char *)s1 - *(unsigned char *)s2;
 }
 
 int strncmp(const char *s1, const char *s2, size_t n)
 {
+	MINQND_PROF(strncmp, 0);
 	const unsigned char *l=(void *)s1, *r=(void *)s2;
 	if (!n--) return 0;
 	for (; *l && *r && n && *l == *r ; l++, r++, n--);
 	return *l - *r;
 }
 
-int memcmp(const void *s1, const void *s2, size_t n)
+int (memcmp)(const void *s1, const void *s2, size_t n)
 {
+	MINQND_PROF(memcmp, n);
 	const unsigned char *l=s1, *r=s2;
 	for (; n && *l == *r; n--, l++, r++);
 	return n ? *l-*r : 0;
 }
 
-char *strcpy(char *s1, const char *s2) { return strncpy(s1, s2, SIZE_MAX); }
+char *strcpy(char *s1, const char *s2)	// its own loop, stpcpy() with its result dropped would be turned back into a strcpy() call
+{
+	MINQND_PROF(strcpy, 0);
+	char *d = s1;
+	while ((*d++ = *s2++)) {}
+	return s1;
+}
 char *strncpy(char *s1, const char *s2, size_t n)
 {
+	MINQND_PROF(strncpy, 0);
 	for (; n && (*s1=*s2); n--, s2++, s1++) {}
 	if (n) *s1 = '\0';
 	return s1;
 }
 
+size_t strnlen(const char *s, size_t maxlen)
+{
+	MINQND_PROF(strnlen, 0);
+	size_t n;
+	for (n=0; n < maxlen && s[n]; n++) {}
+	MINQND_PROF_BYTES(strnlen, n);
+	return n;
+}
+
+char *stpcpy(char *s1, const char *s2)	// returns the end of s1
+{
+	MINQND_PROF(stpcpy, 0);
+	for (; (*s1=*s2); s2++, s1++) {}
+	return s1;
+}
+
+// Like the BSD originals they return the length of what they tried to make so truncation is when the result is >= size
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+	MINQND_PROF(strlcpy, 0);
+	size_t len = strlen(src);
+	if (size)
+	{
+		size_t n = len < size ? len : size-1;
+		memcpy(dst, src, n);
+		dst[n] = '\0';
+	}
+	return len;
+}
+
+size_t strlcat(char *dst, const char *src, size_t size)
+{
+	MINQND_PROF(strlcat, 0);
+	size_t dlen = strnlen(dst, size);
+	if (dlen == size)	// dst isn't terminated within size, nothing can be appended
+		return size + strlen(src);
+	return dlen + strlcpy(&dst[dlen], src, size - dlen);
+}
+
+int sv_cmp(struct str_view a, struct str_view b)
+{
+	MINQND_PROF(sv_cmp, 0);
+	int r = memcmp(a.s, b.s, a.len < b.len ? a.len : b.len);
+	return r ? r : (a.len > b.len) - (a.len < b.len);
+}
+
+size_t sv_find_char(struct str_view v, char c)
+{
+	MINQND_PROF(sv_find_char, 0);
+	const char *p = memchr(v.s, c, v.len);
+	return p ? p - v.s : v.len;
+}
+
+size_t sv_find(struct str_view v, struct str_view needle)
+{
+	MINQND_PROF(sv_find, v.len);
+	if (needle.len == 0)
+		return 0;
+
+	// Find the first char then compare the rest, the last start that fits is v.len - needle.len
+	for (size_t i=0; i + needle.len <= v.len; i++)
+	{
+		const char *p = memchr(&v.s[i], needle.s[0], v.len - needle.len - i + 1);
+		if (p == NULL)
+			break;
+		i = p - v.s;
+		if (memcmp(p+1, needle.s+1, needle.len-1) == 0)
+			return i;
+	}
+	return v.len;
+}
+
+struct str_view sv_split(struct str_view *rest, char sep)
+{
+	MINQND_PROF(sv_split, 0);
+	size_t i = sv_find_char(*rest, sep);
+	struct str_view token = { rest->s, i };
+	i += i < rest->len;	// skip the separator
+	rest->s += i;
+	rest->len -= i;
+	return token;
+}
+
+size_t sv_copy(char *dst, size_t size, struct str_view v)
+{
+	MINQND_PROF(sv_copy, 0);
+	if (size)
+	{
+		size_t n = v.len < size ? v.len : size-1;
+		memcpy(dst, v.s, n);
+		dst[n] = '\0';
+	}
+	return v.len;
+}
+
+int line_iter_next(struct line_iter *it, struct str_view *line)
+{
+	MINQND_PROF(line_iter_next, 0);
+	if (it->p >= it->end)
+		return 0;
+	const char *d = memchr(it->p, it->delim, it->end - it->p);
+	*line = (struct str_view) { it->p, (d ? d : it->end) - it->p };
+	it->p = d ? d+1 : it->end;
+	MINQND_PROF_BYTES(line_iter_next, line->len);
+	return 1;
+}
+
+// The hex loops have no branches or table lookups so that they get vectorised
+MINQND_DISPATCH void hex_encode(char *dst, const void *src, size_t n)	// writes 2n lowercase digits and no null terminator
+{
+	MINQND_PROF(hex_encode, n);
+	const uint8_t *s = src;
+	for (size_t i=0; i < n; i++)
+	{
+		int hi = s[i] >> 4, lo = s[i] & 15;
+		dst[2*i]   = hi + '0' + ((9 - hi) >> 8 & 39);	// + 39 to go from ':' to 'a'
+		dst[2*i+1] = lo + '0' + ((9 - lo) >> 8 & 39);
+	}
+}
+
+static inline uint8_t hex_digit_value(uint8_t c)	// 0x10 if it's not a hex digit
+{
+	uint8_t d = c - '0', l = (c | 32) - 'a';
+	uint8_t is_d = -(d < 10), is_l = -(l < 6);
+	return (d & is_d) | ((l + 10) & is_l) | (0x10 & ~(is_d | is_l));
+}
+
+// Decodes n/2 pairs of digits of either case, returns how many bytes were decoded before the first invalid pair
+MINQND_DISPATCH size_t hex_decode(void *dst, const char *src, size_t n)
+{
+	MINQND_PROF(hex_decode, n);
+	uint8_t *d = dst;
+	size_t i, end, count = n / 2;
+
+	// Blocks of 32 digits are decoded without branches then checked, dst[] can be overwritten past the returned count
+	for (i=0; i < count; i = end)
+	{
+		uint8_t bad = 0;
+		end = i + 16 < count ? i + 16 : count;
+		if (end - i == 16)		// a constant trip count keeps the wider clones from generating masked loops
+			for (size_t j=0; j < 16; j++)
+			{
+				uint8_t hi = hex_digit_value(src[2*(i+j)]), lo = hex_digit_value(src[2*(i+j)+1]);
+				bad |= hi | lo;
+				d[i+j] = hi << 4 | lo;
+			}
+		else
+			for (size_t j=i; j < end; j++)
+			{
+				uint8_t hi = hex_digit_value(src[2*j]), lo = hex_digit_value(src[2*j+1]);
+				bad |= hi | lo;
+				d[j] = hi << 4 | lo;
+			}
+
+		if (bad & 0x10)
+			for (; i < end; i++)
+				if ((hex_digit_value(src[2*i]) | hex_digit_value(src[2*i+1])) & 0x10)
+					return i;
+	}
+
+	return count;
+}
+
+// Formats like hexdump -C (without its last line which is only the end offset), lines start at offset
+// Returns the full length like snprintf() does
+size_t hexdump(char *s, size_t n, const void *data, size_t len, size_t offset)
+{
+	MINQND_PROF(hexdump, len);
+	static const char digits[] = "0123456789abcdef";
+	const uint8_t *p = data;
+	size_t pos = 0;
+
+	for (size_t il=0; il < len; il += 16)
+	{
+		// Lines are written directly unless they might not fit
+		char line[96], *c = pos + sizeof(line) < n ? &s[pos] : line, *line_start = c;
+		size_t line_end = il + 16 < len ? il + 16 : len;
+
+		// Offset, 8 digits unless more are needed
+		uint64_t line_offset = offset + il;
+		for (int sh = line_offset >> 32 ? 60 : 28; sh >= 0; sh -= 4)
+			*c++ = digits[line_offset >> sh & 15];
+		*c++ = ' ';
+
+		// Bytes, with an extra space after 8
+		for (size_t i=il; i < il + 16; i++)
+		{
+			if (i == il + 8)
+				*c++ = ' ';
+			c[0] = ' ';
+			c[1] = i < line_end ? digits[p[i] >> 4] : ' ';
+			c[2] = i < line_end ? digits[p[i] & 15] : ' ';
+			c += 3;
+		}
+
+		// ASCII
+		*c++ = ' ';
+		*c++ = ' ';
+		*c++ = '|';
+		for (size_t i=il; i < line_end; i++)
+			*c++ = (unsigned) p[i] - 0x20 < 0x5f ? p[i] : '.';
+		*c++ = '|';
+		*c++ = '\n';
+
+		// Copy what fits
+		size_t line_len = c - line_start;
+		if (line_start == line && pos < n)
+			memcpy(&s[pos], line, pos + line_len < n ? line_len : n-1 - pos);
+		pos += line_len;
+	}
+
+	if (pos < n)
+		s[pos] = '\0';
+	else if (n)
+		s[n-1] = '\0';
+	return pos;
+}
+
+// Reads one sequence, returns its length or 0 if it's invalid, overlong, a surrogate or above U+10FFFF
+static inline int utf8_decode_one(const uint8_t *p, size_t n, uint32_t *cp)
+{
+	uint8_t c = p[0];
+	int len = c < 0x80 ? 1 : c < 0xC2 ? 0 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : c < 0xF5 ? 4 : 0;
+	if (len == 0 || len > n)
+		return 0;
+
+	uint32_t v = len == 1 ? c : c & (0x7F >> len);
+	for (int i=1; i < len; i++)
+	{
+		if ((p[i] & 0xC0) != 0x80)
+			return 0;
+		v = v << 6 | (p[i] & 0x3F);
+	}
+
+	if ((len == 3 && (v < 0x800 || (v >= 0xD800 && v <= 0xDFFF))) || (len == 4 && (v < 0x10000 || v > 0x10FFFF)))
+		return 0;
+	*cp = v;
+	return len;
+}
+
+// ASCII runs are skipped 32 bytes at a time
+static inline int utf8_is_ascii_32(const uint8_t *p)
+{
+	u64x4 x;
+	__builtin_memcpy(&x, p, 32);
+	return ((x[0] | x[1] | x[2] | x[3]) & 0x8080808080808080ULL) == 0;
+}
+
+MINQND_DISPATCH size_t utf8_validate(const char *s, size_t n)
+{
+	MINQND_PROF(utf8_validate, n);
+	const uint8_t *p = (const uint8_t *) s;
+	size_t i = 0;
+	uint32_t cp;
+
+	while (i < n)
+	{
+		if (n - i >= 32 && utf8_is_ascii_32(&p[i]))
+		{
+			i += 32;
+			continue;
+		}
+
+		int len = utf8_decode_one(&p[i], n - i, &cp);
+		if (len == 0)
+			break;
+		i += len;
+	}
+	return i;
+}
+
+MINQND_DISPATCH size_t utf8_count_codepoints(const char *s, size_t n)
+{
+	MINQND_PROF(utf8_count_codepoints, n);
+	size_t count = 0, i = 0;
+
+	// Continuation bytes are 10xxxxxx, x & ~(x << 1) keeps their top bit
+	for (; n - i >= 32; i += 32)
+	{
+		u64x4 x;
+		__builtin_memcpy(&x, &s[i], 32);
+		x = x & ~(x << 1) & 0x8080808080808080ULL;
+		count += 32 - __builtin_popcountll(x[0]) - __builtin_popcountll(x[1]) - __builtin_popcountll(x[2]) - __builtin_popcountll(x[3]);
+	}
+
+	for (; i < n; i++)
+		count += (s[i] & 0xC0) != 0x80;
+	return count;
+}
+
+MINQND_DISPATCH size_t utf8_decode_n(uint32_t *dst, const char *src, size_t n)
+{
+	MINQND_PROF(utf8_decode_n, n);
+	const uint8_t *p = (const uint8_t *) src;
+	size_t i = 0, count = 0;
+
+	while (i < n)
+	{
+		if (n - i >= 32 && utf8_is_ascii_32(&p[i]))
+		{
+			for (int j=0; j < 32; j++)
+				dst[count+j] = p[i+j];
+			count += 32;
+			i += 32;
+			continue;
+		}
+
+		uint32_t cp = 0xFFFD;
+		int len = utf8_decode_one(&p[i], n - i, &cp);
+		dst[count++] = cp;
+		i += len ? len : 1;
+	}
+	return count;
+}
+
+MINQND_DISPATCH size_t utf8_encode_n(char *dst, const uint32_t *src, size_t n)
+{
+	MINQND_PROF(utf8_encode_n, n);
+	uint8_t *d = (uint8_t *) dst;
+	size_t i = 0, pos = 0;
+
+	while (i < n)
+	{
+		// ASCII runs are narrowed 8 codepoints (32 bytes) at a time
+		if (n - i >= 8)
+		{
+			uint32_t any = 0;
+			for (int j=0; j < 8; j++)
+				any |= src[i+j];
+			if (any < 0x80)
+			{
+				for (int j=0; j < 8; j++)
+					d[pos+j] = src[i+j];
+				pos += 8;
+				i += 8;
+				continue;
+			}
+		}
+
+		uint32_t c = src[i++];
+		if ((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)
+			c = 0xFFFD;
+
+		if (c < 0x80)
+			d[pos++] = c;
+		else if (c < 0x800)
+		{
+			d[pos++] = 0xC0 | c >> 6;
+			d[pos++] = 0x80 | (c & 0x3F);
+		}
+		else if (c < 0x10000)
+		{
+			d[pos++] = 0xE0 | c >> 12;
+			d[pos++] = 0x80 | (c >> 6 & 0x3F);
+			d[pos++] = 0x80 | (c & 0x3F);
+		}
+		else
+		{
+			d[pos++] = 0xF0 | c >> 18;
+			d[pos++] = 0x80 | (c >> 12 & 0x3F);
+			d[pos++] = 0x80 | (c >> 6 & 0x3F);
+			d[pos++] = 0x80 | (c & 0x3F);
+		}
+	}
+	return pos;
+}
+
 #include "minqnd_sprintf.c"
 #include "minqnd_sscanf.c"
 
 
+//**** stdio.h ****
+
+#include "minqnd_stdio.c"
+
+
 //**** time.h ****
 
-time_t time(time_t *timer) { return (time_t) -1; }				// TODO
-double difftime(time_t time1, time_t time0) { return time1 - time0; }
-struct tm *gmtime(const time_t *timer) { return NULL; }				// TODO
-struct tm *gmtime_r(const time_t *timep, struct tm *result) { return NULL; }	// TODO
-struct tm *localtime(const time_t *timer) { return NULL; }			// TODO
-struct tm *localtime_r(const time_t *timep, struct tm *result) { return NULL; }	// TODO
-time_t timegm(struct tm *tm) { return (time_t) -1; }				// TODO
-time_t mktime(struct tm *timeptr) { return (time_t) -1; }			// TODO
-size_t strftime(char * restrict s, size_t maxsize, const char *format, const struct tm *timeptr) { return 0; }	// TODO
+#include "minqnd_time.c"
+
+
+//**** Profiling ****
+
+#ifdef MINQND_PROFILE
+struct minqnd_prof_entry minqnd_prof_table[minqnd_prof_count];
+
+#define X(name) #name,
+const char *const minqnd_prof_name[minqnd_prof_count] = { MINQND_PROF_LIST(X) };
+#undef X
+
+int minqnd_prof_dump(char *s, size_t n)
+{
+	size_t pos = 0;
+	for (int i=0; i < minqnd_prof_count; i++)
+		if (minqnd_prof_table[i].calls)
+		{
+			const struct minqnd_prof_entry *e = &minqnd_prof_table[i];
+			pos += snprintf(pos < n ? &s[pos] : NULL, pos < n ? n-pos : 0, "%s\t%llu calls\t%llu bytes\t%llu ns\n", minqnd_prof_name[i],
+					(unsigned long long) e->calls, (unsigned long long) e->bytes, (unsigned long long) e->ns);
+		}
+	return pos;
+}
+
+void minqnd_prof_reset(void) { memset(minqnd_prof_table, 0, sizeof(minqnd_prof_table)); }
+
+#ifdef __wasm__
+// Lets the host find the table in the module's memory, it's made of minqnd_prof_count entries of 3 uint64_t
+__attribute__((export_name("minqnd_prof_table"))) struct minqnd_prof_entry *minqnd_prof_table_get(void) { return minqnd_prof_table; }
+__attribute__((export_name("minqnd_prof_count"))) int minqnd_prof_count_get(void) { return minqnd_prof_count; }
+#endif
+#endif
 
 
 //**** crt1-reactor.c ****
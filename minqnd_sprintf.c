@@ -17,16 +17,6 @@ double make_power_of_10(int p)
 	return v;
 }
 
-intmax_t make_power_of_10_int(int p)
-{
-	intmax_t v = 1;
-
-	while (p >= 5) { v *= 100000;  p -= 5; }
-	while (p >= 1) { v *= 10;      p -= 1; }
-
-	return v;
-}
-
 int get_power_of_10_exponent(double v)
 {
 	v = fabs(v);
@@ -54,7 +44,280 @@ double apply_power_of_10(double v, int e)
 		return v * make_power_of_10(e);
 }
 
-int vsnprintf(char *s, size_t s_len, const char *fmt, va_list arg)
+// Each conversion is printed by its own function which returns the new s_pos, a module only gets the ones its vsnprintf_core() can reach
+// Define MINQND_PRINTF_NO_FLOAT when no %f, %e or %g is needed, this leaves out print_double() along with floor() and the powers of 10
+
+static size_t print_string(char *s, size_t s_len, size_t s_pos, const char *string, int precision, int field_width, int flag_alt)
+{
+	if (string == NULL)
+		string = "(null)";
+
+	// "precision" = max bytes printed, the string isn't read past it
+	// With # the precision and the field width count UTF-8 codepoints instead
+	int width_used;
+	if (flag_alt)
+	{
+		size_t bytes = 0;
+		int cp_count = 0;
+		if (precision == -1)
+		{
+			bytes = strlen(string);
+			cp_count = utf8_count_codepoints(string, bytes);
+		}
+		else
+			for (; string[bytes]; bytes++)
+				if ((string[bytes] & 0xC0) != 0x80)
+				{
+					if (cp_count == precision)
+						break;
+					cp_count++;
+				}
+		precision = bytes;
+		width_used = cp_count;
+	}
+	else
+		width_used = precision = precision == -1 ? strlen(string) : strnlen(string, precision);
+
+	// Print padding
+	if (field_width)
+		for (int i=0; i < field_width - width_used; i++)
+			if (s_pos++<s_len) s[s_pos-1] = ' ';
+
+	// Copy chars
+	if (s_pos < s_len)
+		memcpy(&s[s_pos], string, precision < s_len - s_pos ? precision : s_len - s_pos);
+	return s_pos + precision;
+}
+
+// The digits are made from the last one with integer divisions only
+static size_t print_dec(char *s, size_t s_len, size_t s_pos, uintmax_t v, int neg)
+{
+	char digits[20];
+	int n = 0;
+	do { digits[n++] = '0' + v % 10; v /= 10; } while (v);
+
+	if (neg)
+		if (s_pos++<s_len) s[s_pos-1] = '-';
+	while (n--)
+		if (s_pos++<s_len) s[s_pos-1] = digits[n];
+	return s_pos;
+}
+
+static size_t print_hex_oct(char *s, size_t s_len, size_t s_pos, uintmax_t vu, char conv_spec, int field_width, int flag_alt, int flag_zero_pad)
+{
+	int is_hex = (conv_spec == 'x' || conv_spec == 'X');
+
+	// Toggle printing 0x
+	int print_0x = 0;
+	if (flag_alt && vu && is_hex)
+	{
+		print_0x = 1;
+		field_width -= 2;
+	}
+
+	int print_zeroes = 0, print_spaces = 0;
+
+	// Print digits, starting from the highest non-zero digit or the start of the padding
+	int sh_inc = is_hex ? 4 : 3;
+	int sh_mask = is_hex ? 0xF : 0x7;
+	int sh_start = ((sizeof(uintmax_t)*8 + sh_inc-1) / sh_inc - 1) * sh_inc;
+	int top_digit = vu ? (63 - __builtin_clzll(vu)) / sh_inc : 0;
+	if (top_digit < field_width - 1)
+		top_digit = field_width - 1;
+	if (top_digit < sh_start / sh_inc)
+		sh_start = top_digit * sh_inc;
+	for (int sh = sh_start; sh >= 0; sh -= sh_inc)
+	{
+		int d = (vu >> sh) & sh_mask;
+
+		// When entering the padding width, TODO: take flag_left_just into account
+		if (sh / sh_inc < field_width)
+		{
+			if (flag_zero_pad)		// toggle printing zeroes
+				print_zeroes = 1;
+			else				// or toggle printing spaces
+				print_spaces = 1;
+		}
+
+		// Toggle printing zeroes if a non-zero digit occurs
+		if (d)
+			print_zeroes = 1;
+
+		// Allow printing 0 at the last digit
+		if (sh == 0)
+			print_zeroes = 1;
+
+		// Print hex digit
+		if (d || print_zeroes)
+		{
+			// Print 0x
+			if (print_0x)
+			{
+				print_0x = 0;
+				if (s_pos++<s_len) s[s_pos-1] = '0';
+				if (s_pos++<s_len) s[s_pos-1] = conv_spec;
+			}
+
+			if (d < 10)
+			{
+				if (s_pos++<s_len) s[s_pos-1] = '0' + d;
+			}
+			else
+			{
+				if (s_pos++<s_len) s[s_pos-1] = (conv_spec == 'X' ? 'A' : 'a') + d - 10;
+			}
+		}
+		// Print space
+		else if (print_spaces)
+		{
+			if (s_pos++<s_len) s[s_pos-1] = ' ';
+		}
+	}
+	return s_pos;
+}
+
+#ifndef MINQND_PRINTF_NO_FLOAT
+static size_t print_double(char *s, size_t s_len, size_t s_pos, double v, char conv_spec, int precision)
+{
+	int capital = 32 * (conv_spec == 'G' || conv_spec == 'F' || conv_spec == 'E');
+	conv_spec += capital;
+
+	// Print and remove sign
+	if (double_as_int(v) & 0x8000000000000000)
+	{
+		if (s_pos++<s_len) s[s_pos-1] = '-';
+		v = -v;
+	}
+
+	// Zero
+	if (v == 0.)
+	{
+		if (s_pos++<s_len) s[s_pos-1] = '0';
+		return s_pos;
+	}
+
+	// NAN
+	if (isnan(v))
+	{
+		if (s_pos++<s_len) s[s_pos-1] = 'n' - capital;
+		if (s_pos++<s_len) s[s_pos-1] = 'a' - capital;
+		if (s_pos++<s_len) s[s_pos-1] = 'n' - capital;
+		return s_pos;
+	}
+
+	// INF
+	if (!isfinite(v))
+	{
+		if (s_pos++<s_len) s[s_pos-1] = 'i' - capital;
+		if (s_pos++<s_len) s[s_pos-1] = 'n' - capital;
+		if (s_pos++<s_len) s[s_pos-1] = 'f' - capital;
+		return s_pos;
+	}
+
+	if (precision == -1)
+		precision = 6;
+
+	// Round up and decide of levels
+	int e10, start_lvl, end_lvl, dot_lvl;
+	double vo = v;
+	for (int i=0; i < 3; i++)
+	{
+		// Rounding
+		if (i)
+			v = vo + apply_power_of_10(5., end_lvl);
+
+		// Decide of levels
+		e10 = get_power_of_10_exponent(v);
+		start_lvl = e10;
+
+		if (conv_spec == 'g')
+		{
+			end_lvl = e10 - (precision ? precision : 1);	// %.0g means one significant digit
+			dot_lvl = e10;
+
+			if (e10 >= -4 && e10 < 0)
+			{
+				start_lvl = 0;
+				dot_lvl = 0;
+			}
+
+			if (start_lvl > 0 && end_lvl < 0)
+				dot_lvl = 0;
+		}
+
+		if (conv_spec == 'f')
+		{
+			if (start_lvl < 0)
+				start_lvl = 0;
+			dot_lvl = 0;
+			end_lvl = -precision - 1;
+		}
+
+		if (conv_spec == 'e')
+		{
+			dot_lvl = start_lvl;
+			end_lvl = start_lvl - precision - 1;
+		}
+	}
+
+	// Print digits
+	int last_pos = s_pos;
+	for (int i=start_lvl; i > end_lvl; i--)
+	{
+		// Extract and subtract digit
+		double d = floor(apply_power_of_10(v, -i));
+		double dm = apply_power_of_10(d, i);
+		if (dm > v)
+		{
+			d -= 1.;
+			dm = apply_power_of_10(d, i);
+		}
+		v -= dm;
+
+		// Print digit and check if it's 0, the zeroes before the dot are never erased
+		if (s_pos++<s_len) s[s_pos-1] = '0' + (int) d;
+		if (d > 0. || i >= dot_lvl)
+			last_pos = s_pos;
+
+		// Print dot
+		if (i == dot_lvl && i != end_lvl+1)
+		{
+			last_pos = s_pos;
+			if (s_pos++<s_len) s[s_pos-1] = '.';
+		}
+	}
+
+	// Erase last zeroes
+	if (conv_spec == 'g')
+		s_pos = last_pos;
+
+	// Print exponent
+	if (dot_lvl || conv_spec == 'e')
+	{
+		if (s_pos++<s_len) s[s_pos-1] = 'e' - capital;
+		if (s_pos++<s_len) s[s_pos-1] = dot_lvl < 0 ? '-' : '+';
+		dot_lvl = abs(dot_lvl);
+		if (dot_lvl >= 100)
+		{
+			if (s_pos++<s_len) s[s_pos-1] = '0' + dot_lvl / 100;
+			dot_lvl -= (dot_lvl / 100) * 100;
+		}
+		if (s_pos++<s_len) s[s_pos-1] = '0' + dot_lvl / 10;
+		dot_lvl -= (dot_lvl / 10) * 10;
+		if (s_pos++<s_len) s[s_pos-1] = '0' + dot_lvl;
+	}
+	return s_pos;
+}
+#endif
+
+// Arguments come either from a va_list or from an array of 64-bit words, see log_deferred()
+// Conversions past the end of the words get 0
+#define ARG_WORD()	(words < words_end ? *words++ : 0)
+#define ARG_INT(type)	(words ? (type) ARG_WORD() : va_arg(*arg, type))
+#define ARG_STRING()	(words ? (const char *) (uintptr_t) ARG_WORD() : va_arg(*arg, const char *))
+#define ARG_DOUBLE()	(words ? int_as_double(ARG_WORD()) : va_arg(*arg, double))
+
+static int vsnprintf_core(char *s, size_t s_len, const char *fmt, va_list *arg, const uint64_t *words, const uint64_t *words_end)
 {
 	size_t f_pos, s_pos = 0;
 
@@ -83,7 +346,7 @@ int vsnprintf(char *s, size_t s_len, const char *fmt, va_list arg)
 			int field_width = 0;
 			if (fmt[f_pos] == '*')
 			{
-				field_width = va_arg(arg, int);
+				field_width = ARG_INT(int);
 				f_pos++;
 			}
 			if (fmt[f_pos] >= '1' && fmt[f_pos] <= '9')
@@ -105,7 +368,7 @@ int vsnprintf(char *s, size_t s_len, const char *fmt, va_list arg)
 				f_pos++;
 				if (fmt[f_pos] == '*')
 				{
-					precision = va_arg(arg, int);
+					precision = ARG_INT(int);
 					f_pos++;
 				}
 				if (fmt[f_pos] >= '0' && fmt[f_pos] <= '9')
@@ -143,39 +406,21 @@ int vsnprintf(char *s, size_t s_len, const char *fmt, va_list arg)
 			// Print char
 			if (conv_spec == 'c')
 			{
-				char c = va_arg(arg, int);
+				char c = ARG_INT(int);
 				if (s_pos++<s_len) s[s_pos-1] = c;
 			}
 
 			// Print string
 			if (conv_spec == 's')
-			{
-				const char *string = va_arg(arg, const char *);
-				if (string == NULL)
-					string = "(null)";
-
-				size_t string_len = strlen(string);
-				if (precision == -1)
-					precision = string_len;		// "precision" = max bytes printed
-				if (precision > string_len)
-					precision = string_len;
-
-				// Print padding
-				if (field_width)
-					for (int i=0; i < field_width - precision; i++)
-						if (s_pos++<s_len) s[s_pos-1] = ' ';
-
-				// Copy chars
-				for (int i=0; i < precision && string[i]; i++)
-					if (s_pos++<s_len) s[s_pos-1] = string[i];
-			}
+				s_pos = print_string(s, s_len, s_pos, ARG_STRING(), precision, field_width, flag_alt);
 
 			// Handle pointer
 			if (conv_spec == 'p')
 			{
-				// Turn %p into %zx
+				// Turn %p into %#zx
 				len_mod = 'z';
 				conv_spec = 'x';
+				flag_alt = 1;
 			}
 
 			// Read integer
@@ -185,268 +430,46 @@ int vsnprintf(char *s, size_t s_len, const char *fmt, va_list arg)
 			{
 				switch (len_mod)
 				{
-						case 'l':  if (len_mod_doubled) vi = va_arg(arg, long long int); else vi = va_arg(arg, long int);
-					break;	case 'j':  vi = va_arg(arg, intmax_t);
-					break;	case 'z':  vi = va_arg(arg, size_t);
-					break;	case 't':  vi = va_arg(arg, ptrdiff_t);
-					break;	default:   vi = va_arg(arg, int);
+						case 'l':  if (len_mod_doubled) vi = ARG_INT(long long int); else vi = ARG_INT(long int);
+					break;	case 'j':  vi = ARG_INT(intmax_t);
+					break;	case 'z':  vi = ARG_INT(size_t);
+					break;	case 't':  vi = ARG_INT(ptrdiff_t);
+					break;	default:   vi = ARG_INT(int);
 				}
 			}
 			else if (conv_spec == 'o' || conv_spec == 'u' || conv_spec == 'x' || conv_spec == 'X')
 			{
 				switch (len_mod)
 				{
-						case 'l':  if (len_mod_doubled) vu = va_arg(arg, unsigned long long int); else vu = va_arg(arg, unsigned long int);
-					break;	case 'j':  vu = va_arg(arg, uintmax_t);
-					break;	case 'z':  vu = va_arg(arg, size_t);
-					break;	case 't':  vu = va_arg(arg, ptrdiff_t);
-					break;	default:   vu = va_arg(arg, unsigned int);
+						case 'l':  if (len_mod_doubled) vu = ARG_INT(unsigned long long int); else vu = ARG_INT(unsigned long int);
+					break;	case 'j':  vu = ARG_INT(uintmax_t);
+					break;	case 'z':  vu = ARG_INT(size_t);
+					break;	case 't':  vu = ARG_INT(ptrdiff_t);
+					break;	default:   vu = ARG_INT(unsigned int);
 				}
 			}
 
-			// Print signed decimal
+			// Print decimal
 			if (conv_spec == 'd' || conv_spec == 'i')
-			{
-				// Print and remove sign
-				if (vi < 0)
-				{
-					if (s_pos++<s_len) s[s_pos-1] = '-';
-					vi = -vi;
-				}
-
-				if (vi == 0)
-					if (s_pos++<s_len) s[s_pos-1] = '0';
-
-				int e10 = get_power_of_10_exponent(vi);
-
-				// Print digits
-				for (; e10 >= 0; e10--)
-				{
-					intmax_t p = make_power_of_10_int(e10);
-					int d = vi / p;
-					if (s_pos++<s_len) s[s_pos-1] = '0' + d;
-					vi -= d * p;
-				}
-			}
-
-			// Print unsigned decimal
+				s_pos = print_dec(s, s_len, s_pos, vi < 0 ? -(uintmax_t) vi : vi, vi < 0);
 			if (conv_spec == 'u')
-			{
-				if (vu == 0)
-					if (s_pos++<s_len) s[s_pos-1] = '0';
+				s_pos = print_dec(s, s_len, s_pos, vu, 0);
 
-				int e10 = get_power_of_10_exponent(vu);
-
-				// Print digits
-				for (; e10 >= 0; e10--)
-				{
-					uintmax_t p = make_power_of_10_int(e10);
-					unsigned int d = vu / p;
-					if (s_pos++<s_len) s[s_pos-1] = '0' + d;
-					vu -= d * p;
-				}
-			}
-
-			// Print hexadecimal
+			// Print hexadecimal or octal
 			if (conv_spec == 'x' || conv_spec == 'X' || conv_spec == 'o')
-			{
-				int is_hex = (conv_spec == 'x' || conv_spec == 'X');
-
-				// Toggle printing 0x
-				int print_0x = 0;
-				if (flag_alt && vu && is_hex)
-				{
-					print_0x = 1;
-					field_width -= 2;
-				}
-
-				int print_zeroes = 0, print_spaces = 0;
-
-				// Print digits
-				int sh_inc = is_hex ? 4 : 3;
-				int sh_mask = is_hex ? 0xF : 0x7;
-				for (int sh = ((sizeof(uintmax_t)*8 + sh_inc-1) / sh_inc - 1) * sh_inc; sh >= 0; sh -= sh_inc)
-				{
-					int d = (vu >> sh) & sh_mask;
-
-					// When entering the padding width, TODO: take flag_left_just into account
-					if (sh / sh_inc < field_width)
-					{
-						if (flag_zero_pad)		// toggle printing zeroes
-							print_zeroes = 1;
-						else				// or toggle printing spaces
-							print_spaces = 1;
-					}
-
-					// Toggle printing zeroes if a non-zero digit occurs
-					if (d)
-						print_zeroes = 1;
-
-					// Allow printing 0 at the last digit
-					if (sh == 0)
-						print_zeroes = 1;
-
-					// Print hex digit
-					if (d || print_zeroes)
-					{
-						// Print 0x
-						if (print_0x)
-						{
-							print_0x = 0;
-							if (s_pos++<s_len) s[s_pos-1] = '0';
-							if (s_pos++<s_len) s[s_pos-1] = conv_spec;
-						}
-
-						if (d < 10)
-						{
-							if (s_pos++<s_len) s[s_pos-1] = '0' + d;
-						}
-						else
-						{
-							if (s_pos++<s_len) s[s_pos-1] = (conv_spec == 'X' ? 'A' : 'a') + d - 10;
-						}
-					}
-					// Print space
-					else if (print_spaces)
-					{
-						if (s_pos++<s_len) s[s_pos-1] = ' ';
-					}
-				}
-			}
+				s_pos = print_hex_oct(s, s_len, s_pos, vu, conv_spec, field_width, flag_alt, flag_zero_pad);
 
 			// Print double
 			if (conv_spec == 'g' || conv_spec == 'G' || conv_spec == 'f' || conv_spec == 'F' || conv_spec == 'e' || conv_spec == 'E')
 			{
-				int capital = 32 * (conv_spec == 'G' || conv_spec == 'F' || conv_spec == 'E');
-				conv_spec += capital;
-
-				double v = va_arg(arg, double);
-
-				// Print and remove sign
-				if (double_as_int(v) & 0x8000000000000000)
-				{
-					if (s_pos++<s_len) s[s_pos-1] = '-';
-					v = -v;
-				}
-
-				// Zero
-				if (v == 0.)
-				{
-					if (s_pos++<s_len) s[s_pos-1] = '0';
-					goto end_double;
-				}
-
-				// NAN
-				if (isnan(v))
-				{
-					if (s_pos++<s_len) s[s_pos-1] = 'n' - capital;
-					if (s_pos++<s_len) s[s_pos-1] = 'a' - capital;
-					if (s_pos++<s_len) s[s_pos-1] = 'n' - capital;
-					goto end_double;
-				}
-
-				// INF
-				if (!isfinite(v))
-				{
-					if (s_pos++<s_len) s[s_pos-1] = 'i' - capital;
-					if (s_pos++<s_len) s[s_pos-1] = 'n' - capital;
-					if (s_pos++<s_len) s[s_pos-1] = 'f' - capital;
-					goto end_double;
-				}
-
-				if (precision == -1)
-					precision = 6;
-
-				// Round up and decide of levels
-				int e10, start_lvl, end_lvl, dot_lvl;
-				double vo = v;
-				for (int i=0; i < 3; i++)
-				{
-					// Rounding
-					if (i)
-						v = vo + apply_power_of_10(5., end_lvl);
-
-					// Decide of levels
-					e10 = get_power_of_10_exponent(v);
-					start_lvl = e10;
-
-					if (conv_spec == 'g')
-					{
-						end_lvl = e10 - precision;
-						dot_lvl = e10;
-
-						if (e10 >= -4 && e10 < 0)
-						{
-							start_lvl = 0;
-							dot_lvl = 0;
-						}
-
-						if (start_lvl > 0 && end_lvl < 0)
-							dot_lvl = 0;
-					}
-
-					if (conv_spec == 'f')
-					{
-						if (start_lvl < 0)
-							start_lvl = 0;
-						dot_lvl = 0;
-						end_lvl = -precision - 1;
-					}
-
-					if (conv_spec == 'e')
-					{
-						dot_lvl = start_lvl;
-						end_lvl = start_lvl - precision - 1;
-					}
-				}
-
-				// Print digits
-				int last_pos = s_pos;
-				for (int i=start_lvl; i > end_lvl; i--)
-				{
-					// Extract and subtract digit
-					double d = floor(apply_power_of_10(v, -i));
-					double dm = apply_power_of_10(d, i);
-					if (dm > v)
-					{
-						d -= 1.;
-						dm = apply_power_of_10(d, i);
-					}
-					v -= dm;
-
-					// Print digit and check if it's 0
-					if (s_pos++<s_len) s[s_pos-1] = '0' + (int) d;
-					if (d > 0.)
-						last_pos = s_pos;
-
-					// Print dot
-					if (i == dot_lvl && i != end_lvl+1)
-					{
-						last_pos = s_pos;
-						if (s_pos++<s_len) s[s_pos-1] = '.';
-					}
-				}
-
-				// Erase last zeroes
-				if (conv_spec == 'g')
-					s_pos = last_pos;
-
-				// Print exponent
-				if (dot_lvl || conv_spec == 'e')
-				{
-					if (s_pos++<s_len) s[s_pos-1] = 'e' - capital;
-					if (s_pos++<s_len) s[s_pos-1] = dot_lvl < 0 ? '-' : '+';
-					dot_lvl = abs(dot_lvl);
-					if (dot_lvl >= 100)
-					{
-						if (s_pos++<s_len) s[s_pos-1] = '0' + dot_lvl / 100;
-						dot_lvl -= (dot_lvl / 100) * 100;
-					}
-					if (s_pos++<s_len) s[s_pos-1] = '0' + dot_lvl / 10;
-					dot_lvl -= (dot_lvl / 10) * 10;
-					if (s_pos++<s_len) s[s_pos-1] = '0' + dot_lvl;
-				}
-			end_double:;
+				double v = ARG_DOUBLE();
+#ifndef MINQND_PRINTF_NO_FLOAT
+				s_pos = print_double(s, s_len, s_pos, v, conv_spec, precision);
+#else
+				(void) v;	// unsupported, printed back without its flags
+				if (s_pos++<s_len) s[s_pos-1] = '%';
+				if (s_pos++<s_len) s[s_pos-1] = conv_spec;
+#endif
 			}
 
 			continue;
@@ -467,6 +490,30 @@ int vsnprintf(char *s, size_t s_len, const char *fmt, va_list arg)
 	return s_pos;
 }
 
+#undef ARG_INT
+#undef ARG_STRING
+#undef ARG_DOUBLE
+#undef ARG_WORD
+
+int vsnprintf(char *s, size_t s_len, const char *fmt, va_list arg)
+{
+	MINQND_PROF(vsnprintf, 0);
+	va_list ap;
+	va_copy(ap, arg);
+	int ret = vsnprintf_core(s, s_len, fmt, &ap, NULL, NULL);
+	va_end(ap);
+	MINQND_PROF_BYTES(vsnprintf, ret);
+	return ret;
+}
+
+int vsnprintf_words(char *s, size_t s_len, const char *fmt, const uint64_t *args, size_t arg_count)
+{
+	MINQND_PROF(vsnprintf_words, 0);
+	int ret = vsnprintf_core(s, s_len, fmt, NULL, args, &args[arg_count]);
+	MINQND_PROF_BYTES(vsnprintf_words, ret);
+	return ret;
+}
+
 int vsprintf(char *s, const char *format, va_list args)
 {
 	return vsnprintf(s, SIZE_MAX, format, args);
@@ -489,3 +536,94 @@ int sprintf(char *s, const char *format, ...)
 	va_end(args);
 	return ret;
 }
+
+void log_ring_init(struct log_ring *r, uint64_t *buf, size_t size)
+{
+	*r = (struct log_ring) { .buf = buf, .size = size };
+}
+
+int log_deferred(struct log_ring *r, const char *format, ...)
+{
+	MINQND_PROF(log_deferred, 0);
+	uint64_t w[LOG_RING_MAX_ARGS];
+	int n = 0;
+	va_list args;
+
+	// Only the argument types are read from the format, the same way vsnprintf() reads them
+	va_start(args, format);
+	for (const char *p = format; *p && n < LOG_RING_MAX_ARGS; p++)
+	{
+		if (*p != '%')
+			continue;
+		p++;
+
+		// Skip flags, field width and precision, a * takes an int argument
+		for (; *p=='-' || *p=='+' || *p==' ' || *p=='#' || *p=='.' || *p=='*' || (*p >= '0' && *p <= '9'); p++)
+			if (*p == '*' && n < LOG_RING_MAX_ARGS)
+				w[n++] = va_arg(args, int);
+
+		char len_mod = 0, len_mod_doubled = 0;
+		while (*p=='h' || *p=='l' || *p=='j' || *p=='z' || *p=='t' || *p=='L')
+		{
+			len_mod_doubled = len_mod == *p;
+			len_mod = *p++;
+		}
+
+		if (n == LOG_RING_MAX_ARGS)
+			break;
+
+		// For integers only the size matters, vsnprintf_words() casts the word back to the type it expects
+		switch (*p)
+		{
+				case 'c': w[n++] = va_arg(args, int);
+			break;	case 's': w[n++] = (uintptr_t) va_arg(args, const char *);
+			break;	case 'p': w[n++] = (uintptr_t) va_arg(args, void *);
+			break;	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+					w[n++] = double_as_int(va_arg(args, double));
+			break;	case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+				switch (len_mod)
+				{
+						case 'l':  if (len_mod_doubled) w[n++] = va_arg(args, long long int); else w[n++] = va_arg(args, long int);
+					break;	case 'j':  w[n++] = va_arg(args, intmax_t);
+					break;	case 'z':  w[n++] = va_arg(args, size_t);
+					break;	case 't':  w[n++] = va_arg(args, ptrdiff_t);
+					break;	default:   w[n++] = va_arg(args, int);
+				}
+			break;	case '\0': p--;	// so that the loop ends
+		}
+	}
+	va_end(args);
+
+	// The record is the format pointer, the word count then the words, it's dropped if it doesn't fit
+	size_t head = r->head, mask = r->size - 1;
+	if (r->size - (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) < 2 + n)
+	{
+		r->dropped++;
+		return 0;
+	}
+
+	r->buf[head & mask] = (uintptr_t) format;
+	r->buf[(head+1) & mask] = n;
+	for (int i=0; i < n; i++)
+		r->buf[(head+2+i) & mask] = w[i];
+	__atomic_store_n(&r->head, head + 2 + n, __ATOMIC_RELEASE);
+	return 1;
+}
+
+// Prints the oldest record into s like snprintf() and removes it, returns -1 if there are no records
+int log_ring_decode(struct log_ring *r, char *s, size_t n)
+{
+	MINQND_PROF(log_ring_decode, 0);
+	size_t tail = r->tail, mask = r->size - 1;
+	if (tail == __atomic_load_n(&r->head, __ATOMIC_ACQUIRE))
+		return -1;
+
+	const char *format = (const char *) (uintptr_t) r->buf[tail & mask];
+	int count = r->buf[(tail+1) & mask];
+	uint64_t w[LOG_RING_MAX_ARGS];
+	for (int i=0; i < count; i++)
+		w[i] = r->buf[(tail+2+i) & mask];
+	__atomic_store_n(&r->tail, tail + 2 + count, __ATOMIC_RELEASE);
+
+	return vsnprintf_words(s, n, format, w, count);	// conversions beyond the recorded words print 0
+}
@@ -1,4 +1,233 @@
-int vsscanf(const char *s, const char *fmt, va_list arg)
+// Reads the digits of an unsigned number in base 2 to 36 and stops at the first invalid one or after n bytes, *end is s if there are none
+// Digits past an overflow are still consumed, *overflow is set and UINT64_MAX is returned
+static uint64_t parse_digits(const char *s, size_t n, const char **end, int base, int *overflow)
+{
+	uint64_t v = 0;
+	*overflow = 0;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && !defined(__SANITIZE_ADDRESS__)
+	// Decimal digits are taken 8 at a time as long as the load doesn't cross a page, so reading past the string's null can't fault
+	if (base == 10)
+		while (n >= 8 && ((uintptr_t) s & 4095) <= 4096-8)
+		{
+			uint64_t w;
+			__builtin_memcpy(&w, s, 8);
+
+			// All 8 bytes must be in '0' to '9', adding 6 carries ':' and above out of the 0x3_ range
+			if (((w & 0xF0F0F0F0F0F0F0F0ULL) | ((w + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4) != 0x3333333333333333ULL)
+				break;
+
+			// Combine pairs of digits, then pairs of pairs, the first char being the most significant
+			w = ((w & 0x0F0F0F0F0F0F0F0FULL) * (1 + (10 << 8))) >> 8;
+			w = ((w & 0x00FF00FF00FF00FFULL) * (1 + (100 << 16))) >> 16;
+			w = ((w & 0x0000FFFF0000FFFFULL) * (1 + (10000ULL << 32))) >> 32;
+
+			*overflow |= __builtin_mul_overflow(v, 100000000, &v) | __builtin_add_overflow(v, w, &v);
+			s += 8;
+			n -= 8;
+		}
+#endif
+
+	for (; n; s++, n--)
+	{
+		unsigned d = (unsigned) (*s - '0') < 10 ? *s - '0' : (unsigned) ((*s | 32) - 'a') < 26 ? (*s | 32) - 'a' + 10 : 36;
+		if (d >= base)
+			break;
+		*overflow |= __builtin_mul_overflow(v, (uint64_t) base, &v) | __builtin_add_overflow(v, d, &v);
+	}
+
+	*end = s;
+	return *overflow ? UINT64_MAX : v;
+}
+
+// Reads an unsigned float, nan or inf from up to s_len bytes, *end is s if there is none
+#define S_AT(i) ((i) < s_len ? s[i] : '\0')
+static double parse_float(const char *s, size_t s_len, const char **end)
+{
+	double vf = 0.;
+	int dot_exp = 1;
+	size_t i = 0;
+	*end = s;
+
+	// Check NAN
+	if (tolower(S_AT(0)) == 'n' && tolower(S_AT(1)) == 'a' && tolower(S_AT(2)) == 'n')
+	{
+		*end = &s[3];
+		return NAN;
+	}
+
+	// Check INF
+	if (tolower(S_AT(0)) == 'i' && tolower(S_AT(1)) == 'n' && tolower(S_AT(2)) == 'f')
+	{
+		*end = &s[3];
+		return INFINITY;
+	}
+
+	// Check validity
+	if (!isdigit(S_AT(0)) && S_AT(0) != '.')
+		return 0.;
+
+	// Read and add up digits and track the dot
+	do
+	{
+		int d = s[i++];
+		if (isdigit(d))
+		{
+			vf = vf*10. + (double) (d-'0');
+			if (dot_exp < 1)
+				dot_exp--;
+		}
+		else
+			dot_exp = 0;
+	}
+	while (isdigit(S_AT(i)) || S_AT(i) == '.');
+
+	if (dot_exp == 1)
+		dot_exp = 0;
+
+	*end = &s[i];
+
+	// Handle exponent, only consumed if it has digits
+	if (S_AT(i) == 'e' || S_AT(i) == 'E')
+	{
+		int e10 = 0, e_neg = 0;
+		i++;
+
+		// Exponent sign
+		if (S_AT(i) == '-' || S_AT(i) == '+')
+			e_neg = (s[i++] == '-');
+
+		if (isdigit(S_AT(i)))
+		{
+			// Exponent digits
+			do
+			{
+				int d = s[i++] - '0';
+				e10 = e10*10 + d;
+			}
+			while (isdigit(S_AT(i)));
+
+			// Apply sign
+			if (e_neg)
+				e10 = -e10;
+
+			dot_exp += e10;
+			*end = &s[i];
+		}
+	}
+
+	// Apply exponent
+	return apply_power_of_10(vf, dot_exp);
+}
+
+// Skips whitespace, the sign and the base prefix, returns the magnitude
+static uint64_t strto_common(const char *nptr, char **endptr, int base, int *neg, int *overflow)
+{
+	const char *s = nptr, *end;
+
+	while (isspace(*s))
+		s++;
+
+	*neg = 0;
+	if (*s == '-' || *s == '+')
+		*neg = (*s++ == '-');
+
+	// 0x is only a prefix if a hex digit follows, otherwise the 0 is the number
+	if ((base == 0 || base == 16) && s[0] == '0' && (s[1] | 32) == 'x' && isxdigit(s[2]))
+	{
+		s += 2;
+		base = 16;
+	}
+	else if (base == 0)
+		base = s[0] == '0' ? 8 : 10;
+
+	uint64_t v = 0;
+	*overflow = 0;
+	end = s;
+	if (base >= 2 && base <= 36)
+		v = parse_digits(s, SIZE_MAX, &end, base, overflow);
+	else
+		errno = EINVAL;
+
+	if (endptr)
+		*endptr = (char *) (end == s ? nptr : end);
+	return v;
+}
+
+// Out of range values are clamped and set errno to ERANGE
+long long strtoll(const char *nptr, char **endptr, int base)
+{
+	MINQND_PROF(strtoll, 0);
+	int neg, overflow;
+	uint64_t v = strto_common(nptr, endptr, base, &neg, &overflow);
+	if (overflow || v > (uint64_t) LLONG_MAX + neg)
+	{
+		errno = ERANGE;
+		return neg ? LLONG_MIN : LLONG_MAX;
+	}
+	return neg ? -v : v;
+}
+
+unsigned long long strtoull(const char *nptr, char **endptr, int base)
+{
+	MINQND_PROF(strtoull, 0);
+	int neg, overflow;
+	uint64_t v = strto_common(nptr, endptr, base, &neg, &overflow);
+	if (overflow)
+	{
+		errno = ERANGE;
+		return ULLONG_MAX;
+	}
+	return neg ? -v : v;
+}
+
+long strtol(const char *nptr, char **endptr, int base)
+{
+	MINQND_PROF(strtol, 0);
+	int neg, overflow;
+	uint64_t v = strto_common(nptr, endptr, base, &neg, &overflow);
+	if (overflow || v > (uint64_t) LONG_MAX + neg)
+	{
+		errno = ERANGE;
+		return neg ? LONG_MIN : LONG_MAX;
+	}
+	return neg ? -v : v;
+}
+
+unsigned long strtoul(const char *nptr, char **endptr, int base)
+{
+	MINQND_PROF(strtoul, 0);
+	int neg, overflow;
+	uint64_t v = strto_common(nptr, endptr, base, &neg, &overflow);
+	if (overflow || v > ULONG_MAX)
+	{
+		errno = ERANGE;
+		return ULONG_MAX;
+	}
+	return neg ? -v : v;
+}
+
+double strtod(const char *nptr, char **endptr)
+{
+	MINQND_PROF(strtod, 0);
+	const char *s = nptr, *end;
+
+	while (isspace(*s))
+		s++;
+
+	int neg = 0;
+	if (*s == '-' || *s == '+')
+		neg = (*s++ == '-');
+
+	double v = parse_float(s, SIZE_MAX, &end);
+	if (endptr)
+		*endptr = (char *) (end == s ? nptr : end);
+	return neg ? -v : v;
+}
+
+// Reads at most s_len bytes of s, S_AT() gives a null past them, *s_end is how far it got
+// Define MINQND_SCANF_NO_FLOAT when no %f, %e or %g is needed so that parse_float() is only linked if strtod() is used
+static int vsscanf_core(const char *s, size_t s_len, const char *fmt, va_list arg, size_t *s_end)
 {
 	int match_count = 0, ret_eof = 1;
 	size_t f_pos, s_pos = 0;
@@ -48,6 +277,7 @@ int vsscanf(const char *s, const char *fmt, va_list arg)
 			// Read conversion specifier
 			char conv_spec = fmt[f_pos];
 			int conv_is_int =   (conv_spec == 'd' || conv_spec == 'i' || conv_spec == 'o' || conv_spec == 'u' || conv_spec == 'x' || conv_spec == 'X');
+			int conv_is_signed = (conv_spec == 'd' || conv_spec == 'i');
 			int conv_is_float = (conv_spec == 'g' || conv_spec == 'G' || conv_spec == 'f' || conv_spec == 'F' || conv_spec == 'e' || conv_spec == 'E');
 
 			if (conv_spec == 'n')
@@ -59,8 +289,11 @@ int vsscanf(const char *s, const char *fmt, va_list arg)
 
 			// Parse %
 			if (conv_spec == '%')
-				if ('%' != s[s_pos++])
+			{
+				if ('%' != S_AT(s_pos))
 					goto eof_reached;
+				s_pos++;
+			}
 
 			// Parse char
 			if (conv_spec == 'c')
@@ -68,7 +301,7 @@ int vsscanf(const char *s, const char *fmt, va_list arg)
 				if (flag_suppr == 0)
 				{
 					char *vc = va_arg(arg, char *);
-					*vc = s[s_pos];
+					*vc = S_AT(s_pos);
 				}
 				s_pos++;
 				match = 1;
@@ -82,7 +315,7 @@ int vsscanf(const char *s, const char *fmt, va_list arg)
 					vs = va_arg(arg, char *);
 
 				int is, scanset_start = f_pos + 1;
-				for (is = 0; s[s_pos] && (!isspace(s[s_pos]) || conv_spec == '[') && field_width; is++, s_pos++, field_width--)
+				for (is = 0; S_AT(s_pos) && (!isspace(s[s_pos]) || conv_spec == '[') && field_width; is++, s_pos++, field_width--)
 				{
 					int i, copy = 0, neg = 0;
 
@@ -140,148 +373,68 @@ int vsscanf(const char *s, const char *fmt, va_list arg)
 				// Turn %p into %zx
 				len_mod = 'z';
 				conv_spec = 'x';
+				conv_is_int = 1;
 			}
 
 			// Read sign
 			int neg = 0;
 			if (conv_is_int || conv_is_float)
-				if (s[s_pos] == '-' || s[s_pos] == '+')
+				if (S_AT(s_pos) == '-' || S_AT(s_pos) == '+')
 					neg = (s[s_pos++] == '-');
 
 			// Skip 0x and handle hexadecimal for %i
 			if (conv_spec == 'i' || conv_spec == 'x' || conv_spec == 'X')
-				if (s[s_pos] == '0' && (s[s_pos+1] == 'x' || s[s_pos+1] == 'X') && isxdigit(s[s_pos+2]))
+				if (S_AT(s_pos) == '0' && (S_AT(s_pos+1) == 'x' || S_AT(s_pos+1) == 'X') && isxdigit(S_AT(s_pos+2)))
 				{
 					s_pos += 2;
 					conv_spec = 'x';
 				}
 
-			// Read decimal
+			// Read integer digits
 			intmax_t vi = 0;
-			if (conv_spec == 'd' || conv_spec == 'i' || conv_spec == 'u')
-			{
-				// Check validity
-				if (!isdigit(s[s_pos]))
-					goto eof_reached;
-				match = 1;
-
-				// Read and add up digits
-				do
-				{
-					int d = s[s_pos++] - '0';
-					vi = vi*10 + d;
-				}
-				while (isdigit(s[s_pos]));
-			}
-
-			// Read hexadecimal
-			if (conv_spec == 'x' || conv_spec == 'X')
+			int overflow = 0;
+			if (conv_is_int)
 			{
-				// Check validity
-				if (!isxdigit(s[s_pos]))
+				const char *end;
+				vi = parse_digits(&s[s_pos], s_pos < s_len ? s_len - s_pos : 0, &end, conv_spec == 'x' || conv_spec == 'X' ? 16 : conv_spec == 'o' ? 8 : 10, &overflow);
+				if (end == &s[s_pos])
 					goto eof_reached;
 				match = 1;
-
-				// Read and add up digits
-				do
-				{
-					int d = s[s_pos++];
-					if (isdigit(d))
-						d -= '0';
-					else if (d <= 'F')
-						d -= 'A' - 10;
-					else
-						d -= 'a' - 10;
-					vi = vi*16 + d;
-				}
-				while (isxdigit(s[s_pos]));
+				s_pos = end - s;
 			}
 
 			// Read float
 			double vf = 0.;
 			if (conv_is_float)
 			{
-				int dot_exp = 1;
-
-				// Check NAN
-				if (tolower(s[s_pos]) == 'n' && tolower(s[s_pos+1]) == 'a' && tolower(s[s_pos+2]) == 'n')
-				{
-					match = 1;
-					vf = NAN;
-					s_pos += 3;
-					goto float_conv_end;
-				}
-
-				// Check INF
-				if (tolower(s[s_pos]) == 'i' && tolower(s[s_pos+1]) == 'n' && tolower(s[s_pos+2]) == 'f')
-				{
-					match = 1;
-					vf = INFINITY;
-					s_pos += 3;
-					goto float_conv_end;
-				}
-
-				// Check validity
-				if (!isdigit(s[s_pos]) && s[s_pos] != '.')
+#ifndef MINQND_SCANF_NO_FLOAT
+				const char *end;
+				vf = parse_float(&s[s_pos], s_pos < s_len ? s_len - s_pos : 0, &end);
+				if (end == &s[s_pos])
 					goto eof_reached;
 				match = 1;
+				s_pos = end - s;
+#else
+				goto eof_reached;	// unsupported, stops like a mismatch
+#endif
+			}
 
-				// Read and add up digits and track the dot
-				do
-				{
-					int d = s[s_pos++];
-					if (isdigit(d))
-					{
-						vf = vf*10. + (double) (d-'0');
-						if (dot_exp < 1)
-							dot_exp--;
-					}
-					else
-						dot_exp = 0;
-				}
-				while (isdigit(s[s_pos]) || s[s_pos] == '.');
-
-				if (dot_exp == 1)
-					dot_exp = 0;
-
-				// Handle exponent
-				if (s[s_pos] == 'e')
-				{
-					int e10 = 0, e_neg = 0;
-					s_pos++;
-
-					// Exponent sign
-					if (s[s_pos] == '-' || s[s_pos] == '+')
-						e_neg = (s[s_pos++] == '-');
-
-					if (isdigit(s[s_pos]))
-					{
-						// Exponent digits
-						do
-						{
-							int d = s[s_pos++] - '0';
-							e10 = e10*10 + d;
-						}
-						while (isdigit(s[s_pos]));
-
-						// Apply sign
-						if (e_neg)
-							e10 = -e10;
-
-						dot_exp += e10;
-					}
-				}
-
-				// Apply exponent
-				vf = apply_power_of_10(vf, dot_exp);
+			// Out of range signed values saturate like strtol() to the limits of the stored type
+			if (conv_is_signed)
+			{
+				uint64_t max = len_mod == 'h' ? (len_mod_doubled ? INT8_MAX : INT16_MAX) : len_mod == 'l' ? (len_mod_doubled ? LLONG_MAX : LONG_MAX) :
+					       len_mod == 'j' ? INTMAX_MAX : len_mod == 'z' || len_mod == 't' ? PTRDIFF_MAX : INT_MAX;
+				if (overflow || (uint64_t) vi > max + neg)
+					vi = max + neg;
 			}
-float_conv_end:
+			else if (overflow)
+				neg = 0;	// UINT64_MAX whatever the sign, like strtoull()
 
 			// Apply sign
 			if (neg)
 			{
 				if (conv_is_int)
-					vi = -vi;
+					vi = -(uint64_t) vi;
 				else
 					vf = -vf;
 			}
@@ -329,23 +482,45 @@ float_conv_end:
 		// Whitespace skipping
 		if (isspace(fmt[f_pos]))
 		{
-			while (isspace(s[s_pos]))
+			while (isspace(S_AT(s_pos)))
 				s_pos++;
 			continue;
 		}
 
 		// Normal char matching
-		if (fmt[f_pos] != s[s_pos++])
+		if (fmt[f_pos] != S_AT(s_pos))
 			goto eof_reached;
+		s_pos++;
 
 		if (fmt[f_pos] == '\0')
 			break;
 	}
 
+	*s_end = s_pos;
 	return match_count;
 eof_reached:
+	*s_end = s_pos;
 	return match_count || ret_eof == 0 ? match_count : EOF;
 }
+#undef S_AT
+
+int vsscanf(const char *s, const char *fmt, va_list arg)
+{
+	MINQND_PROF(vsscanf, 0);
+	size_t s_end;
+	int ret = vsscanf_core(s, SIZE_MAX, fmt, arg, &s_end);
+	MINQND_PROF_BYTES(vsscanf, s_end);
+	return ret;
+}
+
+int vsnscanf(const char *s, size_t n, const char *fmt, va_list arg)
+{
+	MINQND_PROF(vsnscanf, 0);
+	size_t s_end;
+	int ret = vsscanf_core(s, n, fmt, arg, &s_end);
+	MINQND_PROF_BYTES(vsnscanf, s_end);
+	return ret;
+}
 
 int sscanf(const char *s, const char *format, ...)
 {
@@ -355,3 +530,12 @@ int sscanf(const char *s, const char *format, ...)
 	va_end(args);
 	return ret;
 }
+
+int sv_scanf(struct str_view v, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int ret = vsnscanf(v.s, v.len, format, args);
+	va_end(args);
+	return ret;
+}
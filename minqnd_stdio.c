@@ -0,0 +1,525 @@
+#ifdef __wasm__
+// The host does the file operations on its own descriptors, failures are negative
+__attribute__((import_module("env"), import_name("file_open"))) extern int host_file_open(const char *path, int flags);
+__attribute__((import_module("env"), import_name("file_close"))) extern int host_file_close(int fd);
+__attribute__((import_module("env"), import_name("file_read"))) extern ssize_t host_file_read(int fd, void *buf, size_t n);
+__attribute__((import_module("env"), import_name("file_write"))) extern ssize_t host_file_write(int fd, const void *buf, size_t n);
+__attribute__((import_module("env"), import_name("file_seek"))) extern int64_t host_file_seek(int fd, int64_t offset, int whence);
+
+int open(const char *path, int flags, ...) { return host_file_open(path, flags); }
+int close(int fd) { return host_file_close(fd); }
+ssize_t read(int fd, void *buf, size_t n) { return host_file_read(fd, buf, n); }
+ssize_t write(int fd, const void *buf, size_t n) { return host_file_write(fd, buf, n); }
+off_t lseek(int fd, off_t offset, int whence) { return host_file_seek(fd, offset, whence); }
+#else
+#include <sys/mman.h>
+#endif
+
+// Size of the write buffer of files opened for writing only, anything larger is written directly
+#ifndef MINQND_FILE_BUFFER_SIZE
+#define MINQND_FILE_BUFFER_SIZE (64 << 10)
+#endif
+
+FILE *const stdin = NULL;	// there are no standard streams, using them fails
+FILE *const stdout = NULL;
+FILE *const stderr = NULL;
+
+enum
+{
+	FILE_READ = 1, FILE_WRITE = 2, FILE_APPEND = 4, FILE_GROWS = 8, FILE_OWNS_BUF = 16, FILE_EOF = 32, FILE_ERR = 64,
+	FILE_FD = 128,		// buf holds writes pending for fd
+	FILE_MAPPED = 256,	// buf is a read-only mapping of the file
+	FILE_WRITEBACK = 512,	// buf holds the whole file which is written back to fd when dirty
+	FILE_DIRTY = 1024,
+};
+
+// Streams are NULL when opening fails and for stdout and the like, but the compiler takes the FILE arguments
+// of the standard functions as nonnull and would drop a plain check, so it's done where it can't see that
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((noipa, optimize("no-delete-null-pointer-checks")))
+#endif
+static int stream_ok(FILE *f, int mode)
+{
+	return f != NULL && (f->flags & mode);
+}
+
+static int file_mode_flags(const char *mode)
+{
+	int flags = mode[0] == 'r' ? FILE_READ : mode[0] == 'w' ? FILE_WRITE : mode[0] == 'a' ? FILE_WRITE | FILE_APPEND : 0;
+	if (flags && strchr(mode, '+'))
+		flags |= FILE_READ | FILE_WRITE;
+	return flags;
+}
+
+// open_memstream() outputs the buffer and the smaller of the data's end and the position
+static void file_sync(FILE *f)
+{
+	if (f->mem_ptr)
+	{
+		*f->mem_ptr = f->buf;
+		*f->mem_size = f->pos < f->len ? f->pos : f->len;
+	}
+}
+
+static int file_write_all(int fd, const char *p, size_t n)
+{
+	while (n)
+	{
+		ssize_t w = write(fd, p, n);
+		if (w <= 0)
+			return -1;
+		p += w;
+		n -= w;
+	}
+	return 0;
+}
+
+// Pending writes go out in one write(), streams loaded for update are written back whole
+static int file_flush(FILE *f)
+{
+	int ret = 0;
+	if ((f->flags & FILE_FD) && f->len)
+	{
+		ret = file_write_all(f->fd, f->buf, f->len);
+		f->offset += f->len;
+		f->len = f->pos = 0;
+	}
+
+	if (f->flags & FILE_DIRTY)
+	{
+		ret = lseek(f->fd, 0, SEEK_SET) < 0 ? -1 : file_write_all(f->fd, f->buf, f->len);
+		f->flags &= ~FILE_DIRTY;
+	}
+
+	if (ret)
+		f->flags |= FILE_ERR;
+	return ret;
+}
+
+// Reads what's left in the file into a buffer that can grow, with room for the null terminator, a read error sets FILE_ERR and returns -1
+static int file_load(FILE *f, size_t size_hint)
+{
+	ssize_t r = 1;
+	f->size = size_hint + 4096;
+	f->buf = malloc(f->size);
+	while (f->buf && r > 0)
+	{
+		if (f->len + 1 == f->size)
+		{
+			char *p = realloc(f->buf, f->size *= 2);
+			if (p == NULL)
+				free(f->buf);
+			f->buf = p;
+			if (p == NULL)
+				break;
+		}
+
+		r = read(f->fd, &f->buf[f->len], f->size-1 - f->len);
+		f->len += r > 0 ? r : 0;
+	}
+
+	if (f->buf)
+		f->buf[f->len] = '\0';
+	if (r < 0)
+		f->flags |= FILE_ERR;
+	return r < 0 ? -1 : 0;
+}
+
+// Makes room for n bytes and a null terminator if the buffer can grow, returns how many bytes fit at the position
+static size_t file_reserve(FILE *f, size_t n)
+{
+	if (f->flags & FILE_APPEND)
+		f->pos = f->len;
+
+	if ((f->flags & FILE_FD) && f->pos + n >= f->size)
+		file_flush(f);
+
+	if ((f->flags & (FILE_GROWS | FILE_FD)) && f->pos + n >= f->size)
+	{
+		size_t new_size = f->size*2 > f->pos+n+1 ? f->size*2 : f->pos+n+1;
+		char *p = realloc(f->buf, new_size);
+		if (p)
+		{
+			f->buf = p;
+			f->size = new_size;
+		}
+	}
+
+	// Seeking past the end leaves a gap of zeroes
+	if (f->pos > f->len && f->len < f->size)
+		memset(&f->buf[f->len], 0, (f->pos < f->size ? f->pos : f->size) - f->len);
+
+	return f->pos < f->size ? f->size - f->pos : 0;
+}
+
+// Moves past n written bytes, the data stays null-terminated when there's room for it
+static void file_advance(FILE *f, size_t n)
+{
+	f->pos += n;
+	if (f->flags & FILE_WRITEBACK)
+		f->flags |= FILE_DIRTY;
+	if (f->pos >= f->len)
+	{
+		f->len = f->pos;
+		if (f->len < f->size)
+			f->buf[f->len] = '\0';
+	}
+	file_sync(f);
+}
+
+FILE *fopen(const char *filename, const char *mode)
+{
+	MINQND_PROF(fopen, 0);
+	int flags = file_mode_flags(mode);
+	if (flags == 0)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	// Update streams are written back whole so only write-only appending is done by the OS
+	int oflags = flags & FILE_READ ? (flags & FILE_WRITE ? O_RDWR : O_RDONLY) : O_WRONLY;
+	oflags |= mode[0] == 'w' ? O_CREAT | O_TRUNC : mode[0] == 'a' ? O_CREAT : 0;
+	if (flags == (FILE_WRITE | FILE_APPEND))
+		oflags |= O_APPEND;
+
+	int fd = open(filename, oflags, 0666);
+	if (fd < 0)
+		return NULL;
+
+	FILE *f = malloc(sizeof(FILE));
+	if (f == NULL)
+	{
+		close(fd);
+		return NULL;
+	}
+	*f = (FILE) { .fd = fd, .flags = flags | FILE_OWNS_BUF };
+
+	// Written files go through a buffer
+	if ((flags & FILE_READ) == 0)
+	{
+		f->flags |= FILE_FD;
+		f->size = MINQND_FILE_BUFFER_SIZE;
+		f->buf = malloc(f->size);
+		if (flags & FILE_APPEND)
+			f->offset = lseek(fd, 0, SEEK_END);
+	}
+	else
+	{
+		off_t size = lseek(fd, 0, SEEK_END);	// fails for pipes
+		lseek(fd, 0, SEEK_SET);
+
+#ifndef __wasm__
+		// Read-only files are mapped so reading them is only a copy from the page cache
+		if (flags == FILE_READ && size > 0)
+		{
+			void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (map != MAP_FAILED)
+			{
+				f->buf = map;
+				f->size = f->len = size;
+				f->flags = FILE_READ | FILE_MAPPED;
+				return f;
+			}
+		}
+#endif
+
+		// Otherwise the whole file is loaded, like a memory stream, failing to read it fails the open
+		if (file_load(f, size > 0 ? size : 0))
+		{
+			free(f->buf);
+			f->buf = NULL;
+		}
+		f->flags |= FILE_GROWS | (flags & FILE_WRITE ? FILE_WRITEBACK : 0);
+	}
+
+	if (f->buf == NULL)
+	{
+		close(fd);
+		free(f);
+		return NULL;
+	}
+	return f;
+}
+
+FILE *fmemopen(void *buf, size_t size, const char *mode)
+{
+	MINQND_PROF(fmemopen, size);
+	int flags = file_mode_flags(mode);
+	if (flags == 0 || size == 0)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+
+	FILE *f = malloc(sizeof(FILE));
+	if (f == NULL)
+		return NULL;
+	*f = (FILE) { .buf = buf, .size = size, .flags = flags, .fd = -1 };
+
+	if (buf == NULL)
+	{
+		f->buf = malloc(size);
+		if (f->buf == NULL)
+		{
+			free(f);
+			return NULL;
+		}
+		f->buf[0] = '\0';
+		f->flags |= FILE_OWNS_BUF;
+	}
+
+	// r reads the whole buffer, w truncates, a appends after the first null
+	if (mode[0] == 'r' && buf)
+		f->len = size;
+	if (mode[0] == 'w')
+		f->buf[0] = '\0';
+	if (mode[0] == 'a')
+		f->len = f->pos = strnlen(f->buf, size);
+	return f;
+}
+
+FILE *open_memstream(char **ptr, size_t *sizeloc)
+{
+	MINQND_PROF(open_memstream, 0);
+	FILE *f = malloc(sizeof(FILE));
+	char *buf = malloc(64);
+	if (f == NULL || buf == NULL)
+	{
+		free(f);
+		free(buf);
+		return NULL;
+	}
+
+	buf[0] = '\0';
+	*f = (FILE) { .buf = buf, .size = 64, .flags = FILE_WRITE | FILE_GROWS, .fd = -1, .mem_ptr = ptr, .mem_size = sizeloc };
+	file_sync(f);
+	return f;
+}
+
+int fclose(FILE *f)
+{
+	if (!stream_ok(f, FILE_READ | FILE_WRITE))
+		return EOF;
+
+	int ret = file_flush(f);
+	file_sync(f);
+#ifndef __wasm__
+	if (f->flags & FILE_MAPPED)
+		munmap(f->buf, f->size);
+#endif
+	if (f->flags & FILE_OWNS_BUF)
+		free(f->buf);
+	if (f->fd >= 0 && close(f->fd))
+		ret = -1;
+	free(f);
+	return ret ? EOF : 0;
+}
+
+int fflush(FILE *f)
+{
+	MINQND_PROF(fflush, 0);
+	if (f == NULL)
+		return 0;
+	int ret = file_flush(f);
+	file_sync(f);
+	return ret ? EOF : 0;
+}
+
+int vfprintf(FILE *f, const char *format, va_list arg)
+{
+	MINQND_PROF(vfprintf, 0);
+	if (!stream_ok(f, FILE_WRITE))
+		return -1;
+
+	// Overwriting needs the length first so that the byte replaced by the null terminator can be restored
+	va_list ap;
+	int n = 0;
+	if ((f->flags & FILE_APPEND) == 0 && f->pos < f->len)
+	{
+		va_copy(ap, arg);
+		n = vsnprintf(NULL, 0, format, ap);
+		va_end(ap);
+	}
+	size_t room = file_reserve(f, n), written;
+	char saved = f->pos + n < f->len ? f->buf[f->pos + n] : '\0';
+
+	// Format straight into the buffer, a second time after flushing or growing if it turned out too small
+	va_copy(ap, arg);
+	n = vsnprintf(room ? &f->buf[f->pos] : NULL, room, format, ap);
+	va_end(ap);
+	if (n >= room && (f->flags & (FILE_GROWS | FILE_FD)) && (room = file_reserve(f, n)) > n)
+	{
+		va_copy(ap, arg);
+		vsnprintf(&f->buf[f->pos], room, format, ap);
+		va_end(ap);
+	}
+
+	written = n < room ? n : room ? room-1 : 0;
+	if (f->pos + written < f->len)
+		f->buf[f->pos + written] = saved;
+	file_advance(f, written);
+	MINQND_PROF_BYTES(vfprintf, written);
+
+	if (written < n)
+	{
+		f->flags |= FILE_ERR;
+		return -1;
+	}
+	return n;
+}
+
+int fprintf(FILE *stream, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int ret = vfprintf(stream, format, args);
+	va_end(args);
+	return ret;
+}
+
+size_t fwrite(const void *ptr, size_t size, size_t nmemb, FILE *f)
+{
+	MINQND_PROF(fwrite, size * nmemb);
+	if (!stream_ok(f, FILE_WRITE) || size == 0 || (nmemb && size > SIZE_MAX / nmemb))
+		return 0;
+
+	// Large writes to files skip the buffer
+	size_t n = size * nmemb, room;
+	if ((f->flags & FILE_FD) && n >= f->size)
+	{
+		if (file_flush(f) || file_write_all(f->fd, ptr, n))
+		{
+			f->flags |= FILE_ERR;
+			return 0;
+		}
+		f->offset += n;
+		return nmemb;
+	}
+
+	room = file_reserve(f, n);
+	if (n > room)
+	{
+		n = room - room % size;
+		f->flags |= FILE_ERR;
+	}
+	memcpy(&f->buf[f->pos], ptr, n);
+	file_advance(f, n);
+	return n / size;
+}
+
+int fputs(const char *s, FILE *stream)
+{
+	size_t len = strlen(s);
+	return fwrite(s, 1, len, stream) == len ? 0 : EOF;
+}
+
+int fputc(int c, FILE *stream)
+{
+	unsigned char b = c;
+	return fwrite(&b, 1, 1, stream) ? b : EOF;
+}
+
+size_t fread(void *ptr, size_t size, size_t nmemb, FILE *f)
+{
+	MINQND_PROF(fread, 0);
+	if (!stream_ok(f, FILE_READ) || size == 0)
+		return 0;
+
+	size_t avail = f->pos < f->len ? f->len - f->pos : 0, count = nmemb;
+	if (avail / size < count)
+	{
+		count = avail / size;
+		f->flags |= FILE_EOF;
+	}
+	memcpy(ptr, &f->buf[f->pos], count * size);
+	f->pos += count * size;
+	MINQND_PROF_BYTES(fread, count * size);
+	return count;
+}
+
+char *fgets(char *s, int n, FILE *f)
+{
+	MINQND_PROF(fgets, 0);
+	if (!stream_ok(f, FILE_READ) || n <= 0)
+		return NULL;
+
+	size_t avail = f->pos < f->len ? f->len - f->pos : 0, len = n-1 < avail ? n-1 : avail;
+	if (avail == 0)
+	{
+		f->flags |= FILE_EOF;
+		return NULL;
+	}
+
+	// Stop after the first newline
+	const char *nl = memchr(&f->buf[f->pos], '\n', len);
+	if (nl)
+		len = nl - &f->buf[f->pos] + 1;
+	memcpy(s, &f->buf[f->pos], len);
+	s[len] = '\0';
+	f->pos += len;
+	MINQND_PROF_BYTES(fgets, len);
+	return s;
+}
+
+// Read streams hold all their data in buf so the iterator can point straight into it
+struct line_iter line_iter_file(FILE *f, char delim)
+{
+	struct line_iter it = { NULL, NULL, delim };
+	if (!stream_ok(f, FILE_READ))
+		return it;
+
+	if (f->pos < f->len)
+		it = line_iter_init(&f->buf[f->pos], f->len - f->pos, delim);
+	f->pos = f->len;
+	f->flags |= FILE_EOF;
+	return it;
+}
+
+int fgetc(FILE *f)
+{
+	if (!stream_ok(f, FILE_READ))
+		return EOF;
+	if (f->pos >= f->len)
+	{
+		f->flags |= FILE_EOF;
+		return EOF;
+	}
+	return (unsigned char) f->buf[f->pos++];
+}
+
+int fseek(FILE *f, long int offset, int whence)
+{
+	if (!stream_ok(f, FILE_READ | FILE_WRITE))
+		return -1;
+
+	// Written files seek in the file after the pending writes are out
+	if (f->flags & FILE_FD)
+	{
+		off_t r = file_flush(f) ? -1 : lseek(f->fd, offset, whence);
+		if (r < 0)
+			return -1;
+		f->offset = r;
+		f->flags &= ~FILE_EOF;
+		return 0;
+	}
+
+	// Fixed buffers can't be sought past their end, growable ones get a gap of zeroes on the next write
+	size_t base = whence == SEEK_SET ? 0 : whence == SEEK_CUR ? f->pos : f->len;
+	if ((unsigned) whence > SEEK_END || (offset < 0 && -(size_t) offset > base) || ((f->flags & FILE_GROWS) == 0 && base + offset > f->size))
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	f->pos = base + offset;
+	f->flags &= ~FILE_EOF;
+	file_sync(f);
+	return 0;
+}
+
+long int ftell(FILE *f) { return stream_ok(f, FILE_READ | FILE_WRITE) ? (long int) (f->offset + f->pos) : -1; }
+void rewind(FILE *f) { fseek(f, 0, SEEK_SET); clearerr(f); }
+int feof(FILE *f) { return stream_ok(f, FILE_EOF); }
+int ferror(FILE *f) { return stream_ok(f, FILE_ERR); }
+void clearerr(FILE *f) { if (stream_ok(f, FILE_READ | FILE_WRITE)) f->flags &= ~(FILE_EOF | FILE_ERR); }
@@ -0,0 +1,302 @@
+#ifdef __wasm__
+// The host provides the time in nanoseconds, for CLOCK_REALTIME since the Unix epoch
+__attribute__((import_module("env"), import_name("clock_gettime_ns"))) extern int64_t host_clock_gettime_ns(clockid_t clock_id);
+
+int clock_gettime(clockid_t clock_id, struct timespec *tp)
+{
+	int64_t ns = host_clock_gettime_ns(clock_id);
+	tp->tv_sec = ns / 1000000000;
+	tp->tv_nsec = ns - tp->tv_sec * 1000000000;
+	return 0;
+}
+#endif
+
+time_t time(time_t *timer)
+{
+	MINQND_PROF(time, 0);
+	struct timespec ts;
+	time_t t = clock_gettime(CLOCK_REALTIME, &ts) ? (time_t) -1 : ts.tv_sec;
+	if (timer)
+		*timer = t;
+	return t;
+}
+
+double difftime(time_t time1, time_t time0) { return time1 - time0; }
+
+// Days since 1970-01-01 from a proleptic Gregorian date (m = [1 , 12]), no loops and no tables
+// The year is shifted to start in March so that the leap day ends up at the end of the year
+static int64_t days_from_civil(int64_t y, int m, int d)
+{
+	y -= m <= 2;
+	int64_t era = (y >= 0 ? y : y-399) / 400;
+	int yoe = y - era * 400;						// [0 , 399]
+	int doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d-1;			// [0 , 365]
+	int doe = yoe * 365 + yoe/4 - yoe/100 + doy;				// [0 , 146096]
+	return era * 146097 + doe - 719468;
+}
+
+// Inverse of days_from_civil(), also gives the day of the year (yday = [0 , 365])
+static void civil_from_days(int64_t z, int64_t *y, int *m, int *d, int *yday)
+{
+	z += 719468;
+	int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+	int doe = z - era * 146097;						// [0 , 146096]
+	int yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;		// [0 , 399]
+	int doy = doe - (365*yoe + yoe/4 - yoe/100);				// [0 , 365], from March 1st
+	int mp = (5*doy + 2) / 153;						// [0 , 11], from March
+	*d = doy - (153*mp + 2)/5 + 1;
+	*m = mp < 10 ? mp+3 : mp-9;
+	*y = yoe + era * 400 + (*m <= 2);
+
+	// Jan-Feb are at the end of the shifted year, Mar-Dec come after Jan-Feb of the same civil year
+	int leap = yoe % 4 == 0 && (yoe % 100 != 0 || yoe == 0);
+	*yday = doy >= 306 ? doy - 306 : doy + 59 + leap;
+}
+
+struct tm *gmtime_r(const time_t *timep, struct tm *result)
+{
+	MINQND_PROF(gmtime_r, 0);
+	int64_t days = *timep / 86400, y;
+	int secs = *timep - days * 86400;
+	if (secs < 0)
+	{
+		secs += 86400;
+		days--;
+	}
+
+	civil_from_days(days, &y, &result->tm_mon, &result->tm_mday, &result->tm_yday);
+	result->tm_year = y - 1900;
+	result->tm_mon--;
+	result->tm_wday = (days % 7 + 11) % 7;	// 1970-01-01 was a Thursday
+	result->tm_hour = secs / 3600;
+	result->tm_min = secs / 60 % 60;
+	result->tm_sec = secs % 60;
+	result->tm_isdst = 0;
+	return result;
+}
+
+struct tm *gmtime(const time_t *timer)
+{
+	static struct tm tm;
+	return gmtime_r(timer, &tm);
+}
+
+// There are no time zones, local time is UTC
+struct tm *localtime(const time_t *timer) { return gmtime(timer); }
+struct tm *localtime_r(const time_t *timep, struct tm *result) { return gmtime_r(timep, result); }
+
+// Out of range fields are allowed and carry over like in mktime()
+static time_t tm_to_time(const struct tm *tm)
+{
+	int64_t y = tm->tm_year + 1900LL;
+	int mon = tm->tm_mon % 12;
+	y += tm->tm_mon / 12;
+	if (mon < 0)
+	{
+		mon += 12;
+		y--;
+	}
+
+	int64_t days = days_from_civil(y, mon+1, 1) + tm->tm_mday-1;
+	return days * 86400 + tm->tm_hour * 3600LL + tm->tm_min * 60LL + tm->tm_sec;
+}
+
+time_t timegm(struct tm *tm)
+{
+	MINQND_PROF(timegm, 0);
+	time_t t = tm_to_time(tm);
+	gmtime_r(&t, tm);	// normalise the fields
+	return t;
+}
+
+time_t mktime(struct tm *timeptr) { return timegm(timeptr); }
+
+static const char *const strftime_day_name[] = { "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
+static const char *const strftime_month_name[] = { "January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December" };
+
+// Returns where compilation stopped, the end of the format unless the op table is full
+const char *strftime_compile(struct strftime_fmt *f, const char *format)
+{
+	const int op_max = sizeof(f->op) / sizeof(f->op[0]);
+	const char *p = format;
+	f->count = 0;
+
+	while (*p)
+	{
+		// Stop when even the longest composite conversion might not fit
+		if (f->count > op_max - 11)
+			break;
+		struct strftime_op *op = &f->op[f->count++];
+		const char *expansion = NULL;
+
+		// Literal run, points into the format string which must outlive the compiled format
+		if (p[0] != '%' || p[1] == '\0')
+		{
+			op->conv = 0;
+			op->lit = p;
+			op->lit_len = 0;
+			do { p++; op->lit_len++; } while (*p && *p != '%' && op->lit_len < UINT16_MAX);
+			continue;
+		}
+
+		// Conversion
+		p++;
+		if ((*p == 'E' || *p == 'O') && p[1])	// locale modifiers are ignored
+			p++;
+		op->conv = *p;
+		switch (*p++)
+		{
+				case 'F': expansion = "%Y-%m-%d";
+			break;	case 'T': case 'X': expansion = "%H:%M:%S";
+			break;	case 'D': case 'x': expansion = "%m/%d/%y";
+			break;	case 'R': expansion = "%H:%M";
+			break;	case 'r': expansion = "%I:%M:%S %p";
+			break;	case 'c': expansion = "%a %b %e %H:%M:%S %Y";	// 11 ops
+			break;	case 'h': op->conv = 'b';
+			break;	case 'n': op->conv = 0; op->lit = "\n"; op->lit_len = 1;
+			break;	case 't': op->conv = 0; op->lit = "\t"; op->lit_len = 1;
+			break;	case '%': op->conv = 0; op->lit = "%";  op->lit_len = 1;
+		}
+
+		// Composite conversions are turned into their parts, all of them are '%' + char or a single literal char
+		if (expansion)
+		{
+			f->count--;
+			for (const char *e = expansion; *e; e++)
+			{
+				op = &f->op[f->count++];
+				op->conv = 0;
+				if (*e == '%')
+					op->conv = *++e;
+				else
+				{
+					op->lit = e;
+					op->lit_len = 1;
+				}
+			}
+		}
+	}
+
+	return p;
+}
+
+// ISO 8601 weeks start on Monday, a year has 53 of them when it starts or ends on a Thursday
+static int iso_weeks_in_year(int64_t y)
+{
+	int jan1 = (days_from_civil(y, 1, 1) % 7 + 11) % 7;
+	int dec31 = (days_from_civil(y, 12, 31) % 7 + 11) % 7;
+	return jan1 == 4 || dec31 == 4 ? 53 : 52;
+}
+
+// Week 1 is the one with the year's first Thursday, the first and last days can belong to the neighbouring ISO year
+static int iso_week(const struct tm *tm, int64_t *iso_year)
+{
+	int64_t y = tm->tm_year + 1900LL;
+	int w = (tm->tm_yday - (tm->tm_wday + 6) % 7 + 10) / 7;
+	if (w < 1)
+		w = iso_weeks_in_year(--y);
+	else if (w > iso_weeks_in_year(y))
+	{
+		y++;
+		w = 1;
+	}
+	*iso_year = y;
+	return w;
+}
+
+static int strftime_num(char *d, int64_t v, int width, char pad)
+{
+	char digits[20];
+	int n = 0, len = 0;
+	uint64_t u = v < 0 ? -(uint64_t) v : v;
+
+	do { digits[n++] = '0' + u % 10; u /= 10; } while (u);
+
+	if (v < 0)
+		d[len++] = '-';
+	while (n + len < width)
+		d[len++] = pad;
+	while (n)
+		d[len++] = digits[--n];
+	return len;
+}
+
+size_t strftime_compiled(char *s, size_t maxsize, const struct strftime_fmt *f, const struct tm *tm)
+{
+	MINQND_PROF(strftime_compiled, 0);
+	size_t pos = 0;
+	char buf[24];
+	int64_t iso_year;
+
+	if (maxsize == 0)
+		return 0;
+
+	for (int i=0; i < f->count; i++)
+	{
+		const struct strftime_op *op = &f->op[i];
+		const char *src = buf;
+		int len, v;
+
+		switch (op->conv)
+		{
+				case 0:   src = op->lit; len = op->lit_len;
+			break;	case 'Y': len = strftime_num(buf, tm->tm_year + 1900LL, 1, '0');
+			break;	case 'C': v = tm->tm_year + 1900; len = strftime_num(buf, (v - (v < 0) * 99) / 100, 1, '0');
+			break;	case 'y': v = (tm->tm_year + 1900) % 100; len = strftime_num(buf, v < 0 ? v + 100 : v, 2, '0');
+			break;	case 'm': len = strftime_num(buf, tm->tm_mon + 1, 2, '0');
+			break;	case 'd': len = strftime_num(buf, tm->tm_mday, 2, '0');
+			break;	case 'e': len = strftime_num(buf, tm->tm_mday, 2, ' ');
+			break;	case 'j': len = strftime_num(buf, tm->tm_yday + 1, 3, '0');
+			break;	case 'H': len = strftime_num(buf, tm->tm_hour, 2, '0');
+			break;	case 'I': v = tm->tm_hour % 12; len = strftime_num(buf, v ? v : 12, 2, '0');
+			break;	case 'M': len = strftime_num(buf, tm->tm_min, 2, '0');
+			break;	case 'S': len = strftime_num(buf, tm->tm_sec, 2, '0');
+			break;	case 'p': src = tm->tm_hour < 12 ? "AM" : "PM"; len = 2;
+			break;	case 'U': len = strftime_num(buf, (tm->tm_yday + 7 - tm->tm_wday) / 7, 2, '0');
+			break;	case 'W': len = strftime_num(buf, (tm->tm_yday + 7 - (tm->tm_wday + 6) % 7) / 7, 2, '0');
+			break;	case 'V': len = strftime_num(buf, iso_week(tm, &iso_year), 2, '0');
+			break;	case 'G': iso_week(tm, &iso_year); len = strftime_num(buf, iso_year, 1, '0');
+			break;	case 'g': iso_week(tm, &iso_year); v = iso_year % 100; len = strftime_num(buf, v < 0 ? v + 100 : v, 2, '0');
+			break;	case 'u': len = strftime_num(buf, tm->tm_wday ? tm->tm_wday : 7, 1, '0');
+			break;	case 'w': len = strftime_num(buf, tm->tm_wday, 1, '0');
+			break;	case 'a': src = strftime_day_name[tm->tm_wday % 7]; len = 3;
+			break;	case 'A': src = strftime_day_name[tm->tm_wday % 7]; len = strlen(src);
+			break;	case 'b': src = strftime_month_name[tm->tm_mon % 12]; len = 3;
+			break;	case 'B': src = strftime_month_name[tm->tm_mon % 12]; len = strlen(src);
+			break;	case 's': len = strftime_num(buf, tm_to_time(tm), 1, '0');
+			break;	case 'z': src = "+0000"; len = 5;
+			break;	case 'Z': src = "UTC"; len = 3;
+			break;	default:  buf[0] = '%'; buf[1] = op->conv; len = 2;	// unsupported, printed back as-is
+		}
+
+		// Like the standard we return 0 if the result and its null terminator don't fit
+		if (pos + len >= maxsize)
+			return 0;
+		memcpy(&s[pos], src, len);
+		pos += len;
+	}
+
+	s[pos] = '\0';
+	MINQND_PROF_BYTES(strftime_compiled, pos);
+	return pos;
+}
+
+size_t strftime(char * restrict s, size_t maxsize, const char *format, const struct tm *timeptr)
+{
+	MINQND_PROF(strftime, 0);
+	struct strftime_fmt f;
+	size_t pos = 0, len;
+
+	// Long formats are done in as many chunks as needed
+	do
+	{
+		format = strftime_compile(&f, format);
+		len = strftime_compiled(&s[pos], maxsize - pos, &f, timeptr);
+		if (len == 0 && f.count)
+			return 0;
+		pos += len;
+	}
+	while (*format);
+
+	return pos;
+}
@@ -0,0 +1,189 @@
+// Accuracy sweep of the math functions against the native long double libm, it reports the largest absolute,
+// relative and ULP errors with where they happen. Build and run from the repo root with clang or gcc 13+:
+//   cc -O2 -I. tests/accuracy.c -o accuracy -lm -lpthread && ./accuracy
+
+#define MINQND_THREADS
+#define MINQND_LIBC_IMPLEMENTATION
+#include "minqnd_libc.h"
+
+// From the native libm, math.h can't be included next to our header
+extern long double exp2l(long double x), log2l(long double x), sinl(long double x), atan2l(long double y, long double x), tanhl(long double x);
+extern long double asinl(long double x), erfl(long double x), powl(long double x, long double y), fabsl(long double x);
+
+#define THREADS 8
+#define SAMPLES (1 << 22)
+
+enum { F_EXP2, F_LOG2, F_COS_TR, F_ATAN2, F_ASIN, F_ERF, F_POW, F_TANH_N };
+
+// Each argument is taken uniformly in [lo , hi] or with a uniform log2 of its magnitude, optionally with a random sign
+enum { UNIFORM, LOG, LOG_SIGNED };
+struct range { double lo, hi; int scale; };
+
+struct sweep { const char *name, *arg_a, *arg_b; int func; struct range a, b; };
+
+static const struct sweep sweeps[] =
+{
+	{ "exp2",   "x", NULL, F_EXP2,   { -1022., 1023., UNIFORM } },
+	{ "exp2",   "x", NULL, F_EXP2,   { -1., 1., UNIFORM } },
+	{ "log2",   "x", NULL, F_LOG2,   { 1e-300, 1e300, LOG } },
+	{ "log2",   "x", NULL, F_LOG2,   { 0.5, 2., UNIFORM } },
+	{ "cos_tr", "x", NULL, F_COS_TR, { -4., 4., UNIFORM } },
+	{ "atan2",  "y", "x",  F_ATAN2,  { -1., 1., UNIFORM }, { -1., 1., UNIFORM } },
+	{ "atan2",  "y", "x",  F_ATAN2,  { 1e-20, 1e20, LOG_SIGNED }, { 1e-20, 1e20, LOG_SIGNED } },
+	{ "asin",   "x", NULL, F_ASIN,   { -1., 1., UNIFORM } },
+	{ "asin",   "x", NULL, F_ASIN,   { 1e-300, 1., LOG_SIGNED } },
+	{ "erf",    "x", NULL, F_ERF,    { -6., 6., UNIFORM } },
+	{ "erf",    "x", NULL, F_ERF,    { 1e-300, 1., LOG_SIGNED } },
+	{ "pow",    "x", "y",  F_POW,    { 0., 4., UNIFORM }, { -4., 4., UNIFORM } },
+	{ "pow",    "x", "y",  F_POW,    { 1e-3, 1e3, LOG }, { -30., 30., UNIFORM } },
+	{ "tanh_n", "x", NULL, F_TANH_N, { 1e-300, 30., LOG_SIGNED } },
+};
+
+struct worst { double err, a, b; };
+struct result { struct worst abs, rel, ulp; };
+struct job { const struct sweep *s; uint64_t seed; struct result r; };
+
+static double rand_u(uint64_t *s)	// [0 , 1[
+{
+	*s ^= *s << 13; *s ^= *s >> 7; *s ^= *s << 17;
+	return (*s >> 11) * 0x1p-53;
+}
+
+static double rand_arg(uint64_t *s, const struct range *r)
+{
+	if (r->scale == UNIFORM)
+		return r->lo + (r->hi - r->lo) * rand_u(s);
+
+	double l0 = log2(r->lo), l1 = log2(r->hi);
+	double v = exp2(l0 + (l1 - l0) * rand_u(s));
+	return r->scale == LOG_SIGNED && rand_u(s) < 0.5 ? -v : v;
+}
+
+static double ulp_of(double v)
+{
+	v = fabs(v);
+	return int_as_double(double_as_int(v) + 1) - v;		// 2^-1074 for 0
+}
+
+static void update(struct worst *w, double err, double a, double b)
+{
+	if (err > w->err || err != err)
+		*w = (struct worst) { err, a, b };
+}
+
+static void *sweep_task(void *arg)
+{
+	struct job *j = arg;
+	const struct sweep *s = j->s;
+	uint64_t seed = j->seed;
+
+	for (int i=0; i < SAMPLES / THREADS; i++)
+	{
+		double a = rand_arg(&seed, &s->a), b = s->arg_b ? rand_arg(&seed, &s->b) : 0., o;
+		long double r;
+		switch (s->func)
+		{
+				case F_EXP2:   o = exp2(a);     r = exp2l(a);
+			break;	case F_LOG2:   o = log2(a);     r = log2l(a);
+			break;	case F_COS_TR: o = cos_tr(a);   r = sinl(6.283185307179586476925286766559L * (fabsl(a - floor(a) - 0.5L) - 0.25L));	// exact argument near the roots
+			break;	case F_ATAN2:  o = atan2(a, b); r = atan2l(a, b);
+			break;	case F_ASIN:   o = asin(a);     r = asinl(a);
+			break;	case F_ERF:    o = erf(a);      r = erfl(a);
+			break;	case F_POW:    o = pow(a, b);   r = powl(a, b);
+			break;	default:       tanh_n(&o, &a, 1); r = tanhl(a);
+		}
+
+		// Results that are both the same infinity or NaN have no error
+		if (o == r || (o != o && r != r))
+			continue;
+
+		double err = fabsl(o - r);
+		update(&j->r.abs, err, a, b);
+		update(&j->r.rel, r ? err / fabsl(r) : INFINITY, a, b);
+		update(&j->r.ulp, err / ulp_of(r), a, b);
+	}
+	return NULL;
+}
+
+static void print_worst(char *s, size_t n, const char *metric, const struct worst *w, int two_args)
+{
+	int len;
+	if (two_args)
+		len = snprintf(s, n, "\t%s %.3g at (%.17g, %.17g)\n", metric, w->err, w->a, w->b);
+	else
+		len = snprintf(s, n, "\t%s %.3g at %.17g\n", metric, w->err, w->a);
+	write(1, s, len);
+}
+
+static int print_range(char *s, size_t n, const char *arg, const struct range *r)
+{
+	return snprintf(s, n, ", %s in %s[%g , %g]%s", arg, r->scale == LOG_SIGNED ? "+/-" : "", r->lo, r->hi, r->scale == UNIFORM ? "" : " log scale");
+}
+
+// Special values that the sweeps don't reach, returns the number of mismatches
+static int check_special(void)
+{
+	static const double x[] = { 0., -0., 1e-310, 25., -25., INFINITY, -INFINITY, NAN, -NAN };
+	double y[sizeof(x)/sizeof(*x)];
+	char line[128];
+	int fails = 0;
+
+	tanh_n(y, x, sizeof(x)/sizeof(*x));
+	for (int i=0; i < sizeof(x)/sizeof(*x); i++)
+	{
+		double r = tanhl(x[i]);
+		if (y[i] == r ? signbit(y[i]) != signbit(r) : y[i] == y[i] || r == r)
+		{
+			int len = snprintf(line, sizeof(line), "tanh_n(%g) = %g instead of %g\n", x[i], y[i], r);
+			write(1, line, len);
+			fails++;
+		}
+	}
+	return fails;
+}
+
+int main(void)
+{
+	char line[256];
+	int len = snprintf(line, sizeof(line), "%d samples per sweep on %d threads\n", SAMPLES, THREADS);
+	write(1, line, len);
+
+	for (int is=0; is < sizeof(sweeps)/sizeof(*sweeps); is++)
+	{
+		const struct sweep *s = &sweeps[is];
+		struct job jobs[THREADS] = {0};
+		pthread_t threads[THREADS];
+		int started[THREADS];
+
+		for (int it=0; it < THREADS; it++)
+		{
+			jobs[it] = (struct job) { s, 0x9E3779B97F4A7C15ULL * (is * THREADS + it + 1) };
+			started[it] = pthread_create(&threads[it], NULL, sweep_task, &jobs[it]) == 0;
+			if (!started[it])
+				sweep_task(&jobs[it]);
+		}
+		for (int it=0; it < THREADS; it++)
+			if (started[it])
+				pthread_join(threads[it], NULL);
+
+		struct result r = {0};
+		for (int it=0; it < THREADS; it++)
+		{
+			update(&r.abs, jobs[it].r.abs.err, jobs[it].r.abs.a, jobs[it].r.abs.b);
+			update(&r.rel, jobs[it].r.rel.err, jobs[it].r.rel.a, jobs[it].r.rel.b);
+			update(&r.ulp, jobs[it].r.ulp.err, jobs[it].r.ulp.a, jobs[it].r.ulp.b);
+		}
+
+		len = snprintf(line, sizeof(line), "%s(%s%s%s)", s->name, s->arg_a, s->arg_b ? ", " : "", s->arg_b ? s->arg_b : "");
+		len += print_range(&line[len], sizeof(line) - len, s->arg_a, &s->a);
+		if (s->arg_b)
+			len += print_range(&line[len], sizeof(line) - len, s->arg_b, &s->b);
+		line[len++] = '\n';
+		write(1, line, len);
+		print_worst(line, sizeof(line), "abs", &r.abs, s->arg_b != NULL);
+		print_worst(line, sizeof(line), "rel", &r.rel, s->arg_b != NULL);
+		print_worst(line, sizeof(line), "ulp", &r.ulp, s->arg_b != NULL);
+	}
+
+	return check_special() != 0;
+}
@@ -0,0 +1,190 @@
+// Formatted I/O benchmark and differential corpus, the same program is built against this libc and against the native
+// one, each reports MB/s and ns per conversion of sprintf() and sscanf() and writes everything it formatted and a hash
+// of everything it parsed to a file, which must be the same byte for byte. Build and run from the repo root with clang or gcc 13+:
+//   cc -O2 -I. tests/fio_bench.c -o fio && cc -O2 -DNATIVE tests/fio_bench.c -o fio_native
+//   ./fio fio.out && ./fio_native fio_native.out && cmp fio.out fio_native.out
+
+#ifdef NATIVE
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#define MINQND_LIBC_IMPLEMENTATION
+#include "minqnd_libc.h"
+#endif
+
+#define ROWS 200000
+#define REPEATS 3
+
+static char out[ROWS * 96], reprint[ROWS * 32];
+static int ia[ROWS], ib[ROWS];
+static unsigned ic[ROWS];
+static long long id[ROWS];
+static double da[ROWS], df[ROWS], parsed[ROWS];
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static uint64_t rand_u64(uint64_t *s)
+{
+	*s ^= *s << 13; *s ^= *s >> 7; *s ^= *s << 17;
+	return *s;
+}
+
+// 53 random mantissa bits times 10^e10 for e10 in [e10_min , e10_max[, with a random sign
+static double rand_double(uint64_t *s, int e10_min, int e10_max)
+{
+	double m = (rand_u64(s) >> 11) * 0x1p-53;
+	int e10 = e10_min + (int) (rand_u64(s) % (e10_max - e10_min));
+	for (; e10 > 0; e10--) m *= 10.;
+	for (; e10 < 0; e10++) m /= 10.;
+	return rand_u64(s) & 1 ? -m : m;
+}
+
+// Integers of all magnitudes, doubles between 1e-20 and 1e20, and below 1e6 for %.3f where rounding the third decimal
+// stays clear of the relative error of about 1e-16 of the digits
+static void make_inputs(void)
+{
+	uint64_t s = 88172645463325252ULL;
+	for (int i=0; i < ROWS; i++)
+	{
+		ia[i] = (int) rand_u64(&s) >> (rand_u64(&s) & 31);
+		ib[i] = rand_u64(&s) % 100000;
+		ic[i] = rand_u64(&s);
+		id[i] = (long long) rand_u64(&s) >> (rand_u64(&s) & 63);
+		da[i] = rand_double(&s, -20, 20);
+		df[i] = rand_double(&s, -4, 6);
+	}
+}
+
+static void report(const char *func, const char *name, size_t bytes, double ns, int convs)
+{
+	char line[128];
+	int len = snprintf(line, sizeof(line), "%s %s: %.1f MB/s, %.1f ns/conv\n", func, name, bytes / ns * 1e3, ns / convs);
+	write(1, line, len);
+}
+
+// %.17g is only timed, floats agree with an exact implementation up to about 17 digits so its last digit can differ
+static const struct { const char *name, *fmt; int kind, compared; } printf_tests[] =
+{
+	{ "csv ints", "%d,%d,%u,%lld\n", 0, 1 },
+	{ "%g",       "%g\n",            1, 1 },
+	{ "%.17g",    "%.17g\n",         1, 0 },
+	{ "%.3f",     "%.3f\n",          2, 1 },
+	{ "%e",       "%e\n",            1, 1 },
+	{ "%x/%p",    "%x %08x %p\n",    3, 1 },
+};
+
+static const char *const scanf_tests[] = { "csv ints", "%lg", "%[^,]" };
+
+int main(int argc, char **argv)
+{
+	int corpus = argc > 1 ? open(argv[1], O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+	make_inputs();
+
+	for (int it=0; it < sizeof(printf_tests)/sizeof(*printf_tests); it++)
+	{
+		double best = 1e30;
+		size_t len = 0;
+		int convs = 0;
+		for (int rep=0; rep < REPEATS; rep++)
+		{
+			double t0 = now_ns();
+			char *o = out;
+			convs = 0;
+			for (int i=0; i < ROWS; i++)
+				switch (printf_tests[it].kind)
+				{
+						case 0:  o += sprintf(o, printf_tests[it].fmt, ia[i], ib[i], ic[i], id[i]);	convs += 4;
+					break;	case 1:  o += sprintf(o, printf_tests[it].fmt, da[i]);				convs += 1;
+					break;	case 2:  o += sprintf(o, printf_tests[it].fmt, df[i]);				convs += 1;
+					break;	default: o += sprintf(o, printf_tests[it].fmt, ic[i], ib[i], (void *) (uintptr_t) (ic[i] * 16ULL));	convs += 3;
+				}
+			double dt = now_ns() - t0;
+			best = dt < best ? dt : best;
+			len = o - out;
+		}
+		if (corpus >= 0 && printf_tests[it].compared)
+			write(corpus, out, len);
+		report("printf", printf_tests[it].name, len, best, convs);
+	}
+
+	// sscanf() reads back csv lines, each its own string as the native sscanf() calls strlen() on its input.
+	// Their doubles are 15 digit integers times a power of 10 so that both builds read the same text, and as parsed doubles can
+	// differ from the native ones in their last bit the corpus has them printed back to the 15 digits they were read from
+	char *o = out;
+	uint64_t s = 1;
+	for (int i=0; i < ROWS; i++)
+	{
+		uint64_t m = 100000000000000ULL + rand_u64(&s) % 900000000000000ULL;
+		o += sprintf(o, "%d,%d,%u,%lld,word%d,%s%llue%d\n", ia[i], ib[i], ic[i], id[i], i, rand_u64(&s) & 1 ? "-" : "",
+			(unsigned long long) m, (int) (rand_u64(&s) % 40) - 34);
+	}
+	size_t len = o - out;
+	for (char *p = out; p < o; p++)
+		if (*p == '\n')
+			*p = '\0';
+
+	for (int it=0; it < sizeof(scanf_tests)/sizeof(*scanf_tests); it++)
+	{
+		double best = 1e30;
+		uint64_t h = 0;
+		int convs = 0;
+		for (int rep=0; rep < REPEATS; rep++)
+		{
+			double t0 = now_ns();
+			h = 0;
+			convs = 0;
+			int row = 0;
+			for (const char *p = out; p < out + len; p += strlen(p) + 1, row++)
+			{
+				int a, b, n = 0;
+				unsigned c;
+				long long d;
+				double g;
+				char w1[64], w2[64];
+				if (it == 0)
+				{
+					convs += sscanf(p, "%d,%d,%u,%lld", &a, &b, &c, &d);
+					h = h * 31 + a + b + c + d;
+				}
+				else if (it == 1)
+				{
+					convs += sscanf(p, "%*[^,],%*[^,],%*[^,],%*[^,],%*[^,],%lg", &g);
+					parsed[row] = g;
+				}
+				else
+				{
+					convs += sscanf(p, "%[^,],%[^,],%n", w1, w2, &n);
+					h = h * 31 + strlen(w1) * 7 + strlen(w2) + n;
+				}
+			}
+			double dt = now_ns() - t0;
+			best = dt < best ? dt : best;
+		}
+		if (corpus >= 0 && it == 1)
+		{
+			char *r = reprint;
+			for (int i=0; i < ROWS; i++)
+				r += sprintf(r, "%.15g\n", parsed[i]);
+			write(corpus, reprint, r - reprint);
+		}
+		else if (corpus >= 0)
+		{
+			char hash[32];
+			write(corpus, hash, snprintf(hash, sizeof(hash), "%s %llx\n", scanf_tests[it], (unsigned long long) h));
+		}
+		report("scanf", scanf_tests[it], len, best, convs);
+	}
+
+	if (corpus >= 0)
+		close(corpus);
+	return 0;
+}